@@ -33,15 +33,14 @@
 #include "ns3/flow-monitor-helper.h"
 #include "ns3/flow-monitor.h"
 #include "ns3/v4ping-helper.h"
+#include "../comun/perfil.h"
+#include "../comun/fuente-movilidad.h"
 #include <iostream>
 #include <cmath>
 
 
 using namespace ns3;
 
-  int nodos;
-  int timeS;
-
 class AodvExample
 {
 public:
@@ -66,6 +65,14 @@ private:
   bool pcap;
   /// Imprime rutas
   bool printRoutes;
+  /// Ns-2 movement trace file
+  std::string traceFile;
+  /// Mobility source: trace, random or grid
+  std::string mobility;
+  /// Output directory for pcap, routes and flowmon files
+  std::string outDir;
+  /// Measure events and wall time per event type
+  bool profile;
   /// Tamaño de paquetes
   uint32_t m_packetSize = 1024;
 
@@ -78,6 +85,10 @@ private:
   NodeContainer nodes;
   NetDeviceContainer devices;
   Ipv4InterfaceContainer interfaces;
+  /// Runtime profile of Simulator::Run ()
+  tesis::Perfil profiler;
+  /// Node mobility; with a trace, the loaded trajectories
+  tesis::FuenteMovilidad mobilitySource;
 
 private:
   void CreateNodes ();
@@ -88,16 +99,6 @@ private:
 
 int main (int argc, char **argv)
 {
-  
-  std::cout << "Ingrese número de nodos: \n";
-  std::cin >> nodos;
-
-  std::cout << "Ingrese tiempo de simulación: \n";
-  std::cin >> timeS;
-
-  //std::cout << "Ingrese número de conexiones: \n";
-  //std::cin >> sinks;
-
   AodvExample test;
   if (!test.Configure (argc, argv))
     NS_FATAL_ERROR ("Configuration failed. Aborted.");
@@ -109,11 +110,15 @@ int main (int argc, char **argv)
 
 //-----------------------------------------------------------------------------
 AodvExample::AodvExample () :
-  size (nodos),
+  size (0),
   step (40),
-  totalTime (timeS),
+  totalTime (0),
   pcap (true),
   printRoutes (true),
+  traceFile ("src/mobility/examples/udptcp100.ns_movements"),
+  mobility ("trace"),
+  outDir ("graph/TCP/100"),
+  profile (false),
   stopOffset(10.0),
   enableTraffic(true)
 {
@@ -133,15 +138,44 @@ AodvExample::Configure (int argc, char **argv)
   cmd.AddValue ("size", "Number of nodes.", size);
   cmd.AddValue ("time", "Simulation time, s.", totalTime);
   cmd.AddValue ("step", "Grid step, m", step);
+  cmd.AddValue ("traceFile", "Ns2 movement trace file (text or compiled .tray)", traceFile);
+  cmd.AddValue ("mobility", "Mobility source: trace, random or grid", mobility);
+  cmd.AddValue ("outDir", "Output directory", outDir);
+  cmd.AddValue ("profile", "Measure events and wall time per event type", profile);
   cmd.AddValue ("traffic", "Enable Traffic", enableTraffic);
   cmd.Parse (argc, argv);
-  return true;
+
+  // Ask on stdin for whatever was not given on the command line
+  if (size == 0)
+    {
+      std::cout << "Ingrese número de nodos: \n";
+      std::cin >> size;
+    }
+  if (totalTime == 0)
+    {
+      std::cout << "Ingrese tiempo de simulación: \n";
+      std::cin >> totalTime;
+    }
+
+  if (!mobilitySource.SetTipo (mobility))
+    {
+      std::cerr << "Unknown mobility source: " << mobility << "\n";
+      return false;
+    }
+  mobilitySource.SetTraza (traceFile);
+  mobilitySource.SetPaso (step);
+
+  return size > 0 && totalTime > 0;
 }
 
 void
 AodvExample::Run ()
 {
 //  Config::SetDefault ("ns3::WifiRemoteStationManager::RtsCtsThreshold", UintegerValue (1)); // enable rts cts all the time.
+  if (!mobilitySource.Preparar ())
+    {
+      NS_FATAL_ERROR ("Could not read trace " << traceFile);
+    }
   CreateNodes ();
   CreateDevices ();
   InstallInternetStack ();
@@ -158,19 +192,28 @@ AodvExample::Run ()
   flowMonitor = flowMonitorHelper.InstallAll();
 
   Simulator::Stop (Seconds (totalTime));
+  if (profile)
+    {
+      profiler.Iniciar ();
+    }
   Simulator::Run ();
+  if (profile)
+    {
+      profiler.Terminar ();
+    }
   Simulator::Destroy ();
 
   flowMonitor->SetAttribute("DelayBinWidth", DoubleValue(0.01));
   flowMonitor->SetAttribute("JitterBinWidth", DoubleValue(0.01));
   flowMonitor->SetAttribute("PacketSizeBinWidth", DoubleValue(1));
   flowMonitor->CheckForLostPackets();
-  flowMonitor->SerializeToXmlFile("graph/TCP/100/flowMonNodes.xml", true, true);
+  flowMonitor->SerializeToXmlFile(outDir + "/flowMonNodes.xml", true, true);
 }
 
 void
-AodvExample::Report (std::ostream &)
+AodvExample::Report (std::ostream &os)
 {
+  profiler.Reporte (os);
 }
 
 void
@@ -178,9 +221,6 @@ AodvExample::CreateNodes ()
 {
   std::cout << "Creating " << (unsigned)size << " nodes " << step << " m apart.\n";
 
-  std::string traceFile = "src/mobility/examples/udptcp100.ns_movements";
-  CommandLine cmd;
-
   nodes.Create (size);
   
   // Nombre de nodos
@@ -190,22 +230,8 @@ AodvExample::CreateNodes ()
       os << "node-" << i;
       Names::Add (os.str (), nodes.Get (i));
     }
-  // Create static grid
-  MobilityHelper mobility;
-  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
-                                 "MinX", DoubleValue (0.0),
-                                 "MinY", DoubleValue (0.0),
-                                 "DeltaX", DoubleValue (step),
-                                 "DeltaY", DoubleValue (0),
-                                 "GridWidth", UintegerValue (size),
-                                 "LayoutType", StringValue ("RowFirst"));
-  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
-  mobility.Install (nodes);
-
-  cmd.AddValue ("traceFile", "Ns2 movement trace file", traceFile);
-
-  Ns2MobilityHelper ns2 = Ns2MobilityHelper (traceFile);
-  ns2.Install();
+  // One model per node, chosen by --mobility
+  mobilitySource.Instalar (nodes);
 }
 
 void
@@ -222,7 +248,7 @@ AodvExample::CreateDevices ()
 
   if (pcap)
     {
-      wifiPhy.EnablePcapAll (std::string ("graph/TCP/100/aodv"));
+      wifiPhy.EnablePcapAll (outDir + "/aodv");
     }
 }
 
@@ -240,7 +266,7 @@ AodvExample::InstallInternetStack ()
 
   if (printRoutes)
     {
-      Ptr<OutputStreamWrapper> routingStream = Create<OutputStreamWrapper> ("graph/TCP/100/aodv.routes", std::ios::out);
+      Ptr<OutputStreamWrapper> routingStream = Create<OutputStreamWrapper> (outDir + "/aodv.routes", std::ios::out);
       aodv.PrintRoutingTableAllAt (Seconds (8), routingStream);
     }
 }
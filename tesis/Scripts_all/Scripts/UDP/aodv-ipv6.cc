@@ -11,17 +11,21 @@
 #include "ns3/flow-monitor-helper.h"
 #include "ns3/flow-monitor.h"
 #include <iostream>
+#include <map>
+#include <set>
+#include <vector>
 #include <cmath>
+#include <cerrno>
+#include <cstdio>
+#include <sys/wait.h>
+#include <unistd.h>
 #include "ns3/ping6-helper.h"
+#include "../comun/fuente-movilidad.h"
+#include "../comun/canal-cuadricula.h"
+#include "../comun/perfil.h"
  
 using namespace ns3;
 
-    //nodo keyboord
-    int nodo;
-
-    //time keyboard
-    int tm;
- 
 class AodvEjemplo 
 {
     public:
@@ -53,12 +57,89 @@ class AodvEjemplo
         // Imprimir rutas
         bool imprimirRutas;
 
+        // Archivo de movimientos ns-2
+        std::string traceFile;
+
+        // Origen de la movilidad: traza, aleatoria o cuadricula
+        std::string tipoMovilidad;
+
+        // Separacion entre nodos con movilidad en cuadricula (m)
+        double paso;
+
+        // Directorio de salida (pcap, rutas, flowmon)
+        std::string directorio;
+
+        // Replicas de una sola lectura de la traza, cada una en su proceso
+        uint32_t replicas;
+
+        // Variantes de trafico "intervalo:tamano,..." (una rama por variante)
+        std::string textoVariantes;
+
+        // Tiempo simulado comun a todas las variantes antes de ramificar (s)
+        double calentamiento;
+
+        // Canal: "yans", "completo" (espectral, difusion a todos) o
+        // "cuadricula" (espectral, solo receptores dentro del radio de corte)
+        std::string modoCanal;
+
+        // Radio de corte del canal en cuadricula (m), 0 = derivado del umbral
+        // de interferencia (comun/canal-cuadricula.h)
+        double radioCorte;
+
+        // Margen del umbral de interferencia bajo el piso de ruido y el de
+        // CCA, dB
+        double margenCorte;
+
+        // Correr cada replica tambien con el canal completo y la misma
+        // semilla y comparar los flujos de FlowMonitor
+        bool validarCanal;
+
+        // La replica actual es la de referencia de validarCanal
+        bool referenciaCanal;
+
+        // Estadisticas por flujo (origen, destino, puertos) de la replica
+        // de referencia y de la recortada, cada una de su proceso
+        std::map<std::string, FlowMonitor::FlowStats> flujosCanal[2];
+
+        // Medir eventos y tiempo real por tipo durante la simulacion
+        bool perfilar;
+
+        // Nodos servidor y cliente del primer flujo
+        uint32_t servidor;
+        uint32_t cliente;
+
+        // Flujos cliente-servidor; el flujo k desplaza ambos nodos en
+        // k * numNodos / flujos
+        uint32_t flujos;
+
         /// 
         double stopOffset;
 
         /// 
         bool enableTraffic;
  
+        // Variante de trafico: intervalo entre paquetes (s) y tamano (bytes)
+        struct VarianteTrafico
+        {
+            double intervalo;
+            uint32_t tamano;
+        };
+
+        // Variantes a ramificar tras construir la topologia
+        std::vector<VarianteTrafico> variantes;
+
+        // Variante que ejecuta este proceso, -1 sin ramificar
+        int32_t varianteActual;
+
+        // Movilidad de los nodos; con traza, las trayectorias leidas
+        tesis::FuenteMovilidad movilidad;
+
+        // Canal espectral de la replica actual (modos completo y cuadricula)
+        Ptr<tesis::CanalCuadricula> canalCuadricula;
+
+        // Perfil de ejecucion de la replica
+        tesis::Perfil perfil;
+
         // Contenedor de nodos
         NodeContainer nodos;
          
@@ -71,6 +152,30 @@ class AodvEjemplo
      
     private:
      
+        // Una replica en un proceso hijo, para que no herede direcciones ni
+        // flujos aleatorios de las anteriores; con referencia usa el canal
+        // completo. Los flujos de validarCanal vuelven por un tubo
+        void ReplicaEnHijo (uint32_t corrida, bool referencia);
+
+        // Una replica completa de la simulacion
+        void EjecutarReplica ();
+
+        // Sufijo de los archivos de salida de la replica actual
+        std::string Sufijo () const;
+
+        // Un proceso hijo por variante de trafico sobre la misma topologia
+        void Ramificar ();
+
+        // Correr la simulacion y guardar FlowMonitor
+        void Simular ();
+
+        // Diferencias por flujo entre el canal completo y el recortado
+        void CompararCanal (std::ostream &os) const;
+
+        // Retardo hasta el instante absoluto t (s), para programar despues
+        // del calentamiento
+        Time Instante (double t) const;
+
         // Creacion de nodos
         void CrearNodos ();
          
@@ -82,13 +187,34 @@ class AodvEjemplo
          
         // Instalacion de aplicaciones de red
         void InstalarAplicaciones ();
+
+        // Trazas PCAP y volcado de rutas
+        void InstalarTrazas ();
 };
  
 AodvEjemplo::AodvEjemplo () : 
-    numNodos (nodo), 
-    tiempoTotal (tm),
+    numNodos (0), 
+    tiempoTotal (0),
+    pcap (true),
+    imprimirRutas (true),
+    traceFile ("src/mobility/examples/udptcp100.ns_movements"),
+    tipoMovilidad ("traza"),
+    paso (40.0),
+    directorio ("graphs/UDP/100"),
+    replicas (1),
+    calentamiento (0),
+    modoCanal ("yans"),
+    radioCorte (0),
+    margenCorte (20.0),
+    validarCanal (false),
+    referenciaCanal (false),
+    perfilar (false),
+    servidor (1),
+    cliente (80),
+    flujos (1),
     stopOffset (20.0),
-    enableTraffic (true)
+    enableTraffic (true),
+    varianteActual (-1)
 {
 }
  
@@ -105,22 +231,258 @@ AodvEjemplo::Configurar (int argc, char *argv[])
     cmd.AddValue ("imprimirRutas", "Imprimir tabla de enrutamiento.", imprimirRutas);
     cmd.AddValue ("numNodos", "Numero de nodos.", numNodos);
     cmd.AddValue ("tiempoTotal", "Tiempo de simulacion, s.", tiempoTotal);
+    cmd.AddValue ("traceFile", "Ns2 movement trace file (text or compiled .tray)", traceFile);
+    cmd.AddValue ("movilidad", "Movilidad: traza, aleatoria o cuadricula.", tipoMovilidad);
+    cmd.AddValue ("paso", "Separacion entre nodos en cuadricula, m.", paso);
+    cmd.AddValue ("directorio", "Directorio de salida.", directorio);
+    cmd.AddValue ("replicas", "Replicas de una sola lectura de la traza (RngRun, RngRun+1, ...).", replicas);
+    cmd.AddValue ("variantes", "Variantes de trafico intervalo:tamano separadas por comas.", textoVariantes);
+    cmd.AddValue ("calentamiento", "Simular hasta este instante (s) antes de ramificar.", calentamiento);
+    cmd.AddValue ("canal", "Canal wifi: yans, completo o cuadricula.", modoCanal);
+    cmd.AddValue ("radioCorte", "Radio de corte del canal en cuadricula, m (0 = automatico).", radioCorte);
+    cmd.AddValue ("margenCorte", "Margen del corte bajo el piso de ruido y el umbral de CCA, dB.", margenCorte);
+    cmd.AddValue ("validarCanal", "Comparar cada replica en cuadricula con el canal completo.", validarCanal);
+    cmd.AddValue ("perfil", "Medir eventos y tiempo real por tipo de evento.", perfilar);
+    cmd.AddValue ("servidor", "Nodo servidor del primer flujo.", servidor);
+    cmd.AddValue ("cliente", "Nodo cliente del primer flujo.", cliente);
+    cmd.AddValue ("flujos", "Numero de flujos cliente-servidor.", flujos);
  
     cmd.Parse (argc, argv);
-    return true;
+
+    // Sin parametros por linea de comandos se piden por teclado
+    if (numNodos == 0)
+    {
+        std::cout << "Ingrese número de nodos: \n";
+        std::cin >> numNodos;
+    }
+
+    if (tiempoTotal == 0)
+    {
+        std::cout << "Ingrese tiempo total: \n";
+        std::cin >> tiempoTotal;
+    }
+
+    std::istringstream is (textoVariantes);
+    std::string texto;
+    while (std::getline (is, texto, ','))
+    {
+        VarianteTrafico v;
+        if (std::sscanf (texto.c_str (), "%lf:%u", &v.intervalo, &v.tamano) != 2 || v.intervalo <= 0)
+        {
+            std::cerr << "Variante no valida: " << texto << "\n";
+            return false;
+        }
+        variantes.push_back (v);
+    }
+
+    if (!movilidad.SetTipo (tipoMovilidad))
+    {
+        std::cerr << "Movilidad desconocida: " << tipoMovilidad << "\n";
+        return false;
+    }
+    movilidad.SetTraza (traceFile);
+    movilidad.SetPaso (paso);
+    // Random Waypoint: 150 x 150 m, velocidad uniforme hasta 20 m/s, sin pausa
+    movilidad.SetAleatoria (150.0, 150.0, 20.0, 0.0);
+
+    if (modoCanal != "yans" && modoCanal != "completo" && modoCanal != "cuadricula")
+    {
+        std::cerr << "Canal desconocido: " << modoCanal << "\n";
+        return false;
+    }
+    // La cuadricula del canal se reconstruye con los cambios de rumbo
+    if (modoCanal == "cuadricula")
+    {
+        Config::SetDefault ("tesis::MovilidadTrayectoria::NotificarRumbo", BooleanValue (true));
+    }
+    // Las variantes corren en procesos hijos y no devuelven sus flujos
+    if (validarCanal && (modoCanal != "cuadricula" || !textoVariantes.empty ()))
+    {
+        std::cerr << "validarCanal requiere canal=cuadricula y sin variantes\n";
+        return false;
+    }
+
+    // Las aplicaciones se instalan despues del calentamiento
+    if (calentamiento < 0 || calentamiento > 19.0)
+    {
+        std::cerr << "El calentamiento debe terminar antes de que arranquen las aplicaciones (19 s)\n";
+        return false;
+    }
+
+    if (numNodos > 0 && (servidor >= numNodos || cliente >= numNodos || servidor == cliente || flujos == 0))
+    {
+        std::cerr << "Flujos no validos: servidor " << servidor << ", cliente " << cliente
+                  << ", " << flujos << " flujos con " << numNodos << " nodos\n";
+        return false;
+    }
+    // Un puerto por flujo desde el de la aplicacion, sin llegar a los
+    // efimeros (49152)
+    if (flujos > 40000)
+    {
+        std::cerr << "Demasiados flujos: " << flujos << "\n";
+        return false;
+    }
+
+    return numNodos > 0 && tiempoTotal > 0;
 }
  
 void
 AodvEjemplo::Ejecutar ()
+{
+    // La traza se lee una sola vez para todas las replicas
+    if (!movilidad.Preparar ())
+    {
+        NS_FATAL_ERROR ("No se pudo leer la traza " << traceFile);
+    }
+
+    // Cada replica usa su propio numero de corrida a partir de --RngRun
+    uint32_t corridaBase = SeedManager::GetRun ();
+    if (replicas == 1 && !validarCanal)
+    {
+        EjecutarReplica ();
+        return;
+    }
+    for (uint32_t r = 0; r < replicas; ++r)
+    {
+        // La referencia y la recortada parten del mismo estado: mismas
+        // direcciones y mismos flujos aleatorios, solo cambia el canal
+        if (validarCanal)
+        {
+            ReplicaEnHijo (corridaBase + r, true);
+        }
+        ReplicaEnHijo (corridaBase + r, false);
+        if (validarCanal)
+        {
+            CompararCanal (std::cout);
+        }
+    }
+}
+
+void
+AodvEjemplo::ReplicaEnHijo (uint32_t corrida, bool referencia)
+{
+    // ns-3 no reinicia el contador de Mac48Address::Allocate (de donde
+    // salen las direcciones IPv6) ni el indice de flujos de RngSeedManager;
+    // el hijo parte del estado recien configurado y la replica queda igual
+    // a una corrida nueva con ese RngRun
+    int tubo[2];
+    if (pipe (tubo) != 0)
+    {
+        NS_FATAL_ERROR ("pipe () fallo en la corrida " << corrida);
+    }
+    std::map<std::string, FlowMonitor::FlowStats> &flujos = flujosCanal[referencia ? 0 : 1];
+    std::cout.flush ();
+    pid_t pid = fork ();
+    if (pid < 0)
+    {
+        NS_FATAL_ERROR ("fork () fallo en la corrida " << corrida);
+    }
+    if (pid == 0)
+    {
+        close (tubo[0]);
+        SeedManager::SetRun (corrida);
+        referenciaCanal = referencia;
+        EjecutarReplica ();
+        Reporte (std::cout);
+        std::cout.flush ();
+
+        // Flujos de validarCanal para el padre: clave, tx, rx y retardo
+        std::ostringstream os;
+        for (std::map<std::string, FlowMonitor::FlowStats>::const_iterator i = flujos.begin (); i != flujos.end (); ++i)
+        {
+            os << i->first << "\t" << i->second.txPackets << " " << i->second.rxPackets << " "
+               << i->second.delaySum.GetTimeStep () << "\n";
+        }
+        std::string texto = os.str ();
+        for (std::string::size_type hecho = 0; hecho < texto.size (); )
+        {
+            ssize_t n = write (tubo[1], texto.data () + hecho, texto.size () - hecho);
+            if (n < 0 && errno != EINTR)
+            {
+                _exit (1);
+            }
+            hecho += n > 0 ? n : 0;
+        }
+        close (tubo[1]);
+        _exit (0);
+    }
+
+    close (tubo[1]);
+    std::string texto;
+    char bloque[4096];
+    ssize_t n;
+    while ((n = read (tubo[0], bloque, sizeof (bloque))) != 0)
+    {
+        if (n < 0 && errno != EINTR)
+        {
+            break;
+        }
+        texto.append (bloque, n > 0 ? n : 0);
+    }
+    close (tubo[0]);
+
+    int estado = 0;
+    if (waitpid (pid, &estado, 0) < 0 || !WIFEXITED (estado) || WEXITSTATUS (estado) != 0)
+    {
+        NS_FATAL_ERROR ("La corrida " << corrida << " fallo");
+    }
+
+    flujos.clear ();
+    std::istringstream is (texto);
+    std::string linea;
+    while (std::getline (is, linea))
+    {
+        std::string::size_type tab = linea.rfind ('\t');
+        unsigned long long tx = 0;
+        unsigned long long rx = 0;
+        long long retardo = 0;
+        if (tab == std::string::npos
+            || std::sscanf (linea.c_str () + tab + 1, "%llu %llu %lld", &tx, &rx, &retardo) != 3)
+        {
+            NS_FATAL_ERROR ("Flujo no valido de la corrida " << corrida << ": " << linea);
+        }
+        FlowMonitor::FlowStats &x = flujos[linea.substr (0, tab)];
+        x.txPackets = tx;
+        x.rxPackets = rx;
+        x.delaySum = TimeStep (retardo);
+    }
+}
+
+void
+AodvEjemplo::EjecutarReplica ()
 {
     CrearNodos ();
     CrearDispositivos ();
     InstalarProtocolos ();
+
+    if (calentamiento > 0)
+    {
+        // Punto de partida comun: posiciones, tablas AODV, vecinos y
+        // temporizadores pendientes al final del calentamiento quedan en
+        // memoria y los hijos los heredan al ramificar
+        std::cout << "Calentamiento hasta " << calentamiento << " s\n";
+        Simulator::Stop (Seconds (calentamiento));
+        Simulator::Run ();
+    }
+
+    if (!variantes.empty ())
+    {
+        Ramificar ();
+        return;
+    }
+
+    InstalarTrazas ();
     if (enableTraffic)
       {
     InstalarAplicaciones ();
       }
- 
+
+    Simular ();
+}
+
+void
+AodvEjemplo::Simular ()
+{
     std::cout << "Iniciando simulacion por " << tiempoTotal << " segundos...\n";
  
     //FlowMonitor
@@ -128,20 +490,162 @@ AodvEjemplo::Ejecutar ()
     FlowMonitorHelper flowMonitorHelper;
     flowMonitor = flowMonitorHelper.InstallAll();  
  
-    Simulator::Stop (Seconds (tiempoTotal));
+    Simulator::Stop (Instante (tiempoTotal));
+    if (perfilar)
+    {
+        perfil.Iniciar ();
+    }
     Simulator::Run ();
+    if (perfilar)
+    {
+        perfil.Terminar ();
+    }
+
+    if (canalCuadricula != 0)
+    {
+        canalCuadricula->Reporte (std::cout);
+    }
     Simulator::Destroy ();
 
     flowMonitor->SetAttribute("DelayBinWidth", DoubleValue(0.01));
     flowMonitor->SetAttribute("JitterBinWidth", DoubleValue(0.01));
     flowMonitor->SetAttribute("PacketSizeBinWidth", DoubleValue(1));
     flowMonitor->CheckForLostPackets();
-    flowMonitor->SerializeToXmlFile("graphs/UDP/100/flowMonNodes.xml", true, true);
+    flowMonitor->SerializeToXmlFile(directorio + "/flowMonNodes" + Sufijo () + ".xml", true, true);
+
+    if (validarCanal)
+    {
+        Ptr<Ipv6FlowClassifier> clasificador = DynamicCast<Ipv6FlowClassifier> (flowMonitorHelper.GetClassifier6 ());
+        std::map<std::string, FlowMonitor::FlowStats> &flujos = flujosCanal[referenciaCanal ? 0 : 1];
+        flujos.clear ();
+        FlowMonitor::FlowStatsContainer estadisticas = flowMonitor->GetFlowStats ();
+        for (FlowMonitor::FlowStatsContainer::const_iterator i = estadisticas.begin (); i != estadisticas.end (); ++i)
+        {
+            Ipv6FlowClassifier::FiveTuple t = clasificador->FindFlow (i->first);
+            std::ostringstream clave;
+            clave << t.sourceAddress << " " << t.sourcePort << " -> " << t.destinationAddress << " "
+                  << t.destinationPort << " " << uint32_t (t.protocol);
+            flujos[clave.str ()] = i->second;
+        }
+    }
+}
+
+void
+AodvEjemplo::CompararCanal (std::ostream &os) const
+{
+    const std::map<std::string, FlowMonitor::FlowStats> &completo = flujosCanal[0];
+    const std::map<std::string, FlowMonitor::FlowStats> &recortado = flujosCanal[1];
+    std::set<std::string> claves;
+    for (std::map<std::string, FlowMonitor::FlowStats>::const_iterator i = completo.begin (); i != completo.end (); ++i)
+    {
+        claves.insert (i->first);
+    }
+    for (std::map<std::string, FlowMonitor::FlowStats>::const_iterator i = recortado.begin (); i != recortado.end (); ++i)
+    {
+        claves.insert (i->first);
+    }
+
+    FlowMonitor::FlowStats vacio = FlowMonitor::FlowStats ();
+    uint32_t distintos = 0;
+    for (const std::string &clave : claves)
+    {
+        std::map<std::string, FlowMonitor::FlowStats>::const_iterator a = completo.find (clave);
+        std::map<std::string, FlowMonitor::FlowStats>::const_iterator b = recortado.find (clave);
+        const FlowMonitor::FlowStats &x = a != completo.end () ? a->second : vacio;
+        const FlowMonitor::FlowStats &y = b != recortado.end () ? b->second : vacio;
+        if (x.txPackets == y.txPackets && x.rxPackets == y.rxPackets && x.delaySum == y.delaySum)
+        {
+            continue;
+        }
+        ++distintos;
+        os << "  " << clave << ": tx " << x.txPackets << "/" << y.txPackets
+           << ", rx " << x.rxPackets << "/" << y.rxPackets
+           << ", retardo " << x.delaySum.GetSeconds () << "/" << y.delaySum.GetSeconds () << " s\n";
+    }
+    os << "Validacion del canal (completo/recortado): " << claves.size () << " flujos, "
+       << distintos << " distintos\n";
+}
+
+void
+AodvEjemplo::Ramificar ()
+{
+    // Cada variante corre en un proceso hijo que parte de la topologia ya
+    // construida; la memoria del padre se comparte copy-on-write
+    std::cout << "Ramificando " << variantes.size () << " variantes de trafico\n";
+    std::cout.flush ();
+
+    std::vector<pid_t> hijos;
+    for (uint32_t v = 0; v < variantes.size (); ++v)
+    {
+        pid_t pid = fork ();
+        if (pid < 0)
+        {
+            NS_FATAL_ERROR ("fork () fallo en la variante " << v);
+        }
+        if (pid == 0)
+        {
+            varianteActual = v;
+            InstalarTrazas ();
+            if (enableTraffic)
+            {
+                InstalarAplicaciones ();
+            }
+            Simular ();
+            Reporte (std::cout);
+            std::cout.flush ();
+            _exit (0);
+        }
+        hijos.push_back (pid);
+    }
+
+    uint32_t fallidas = 0;
+    for (pid_t pid : hijos)
+    {
+        int estado = 0;
+        if (waitpid (pid, &estado, 0) < 0 || !WIFEXITED (estado) || WEXITSTATUS (estado) != 0)
+        {
+            ++fallidas;
+        }
+    }
+
+    // El padre no simula; solo libera la topologia compartida
+    Simulator::Destroy ();
+
+    if (fallidas > 0)
+    {
+        NS_FATAL_ERROR (fallidas << " de " << variantes.size () << " variantes fallaron");
+    }
+}
+
+Time
+AodvEjemplo::Instante (double t) const
+{
+    return Seconds (t) - Simulator::Now ();
+}
+
+std::string
+AodvEjemplo::Sufijo () const
+{
+    std::ostringstream os;
+    if (replicas > 1)
+    {
+        os << "-corrida-" << SeedManager::GetRun ();
+    }
+    if (referenciaCanal)
+    {
+        os << "-completo";
+    }
+    if (varianteActual >= 0)
+    {
+        os << "-variante-" << varianteActual;
+    }
+    return os.str ();
 }
  
 void
-AodvEjemplo::Reporte (std::ostream &)
-{ 
+AodvEjemplo::Reporte (std::ostream &os)
+{
+    perfil.Reporte (os);
 }
  
 void
@@ -149,10 +653,6 @@ AodvEjemplo::CrearNodos ()
 {
     std::cout << "Creando " << numNodos << " nodos.\n";
 
-    std::string traceFile = "src/mobility/examples/udptcp100.ns_movements";
-    CommandLine cmd;
-    cmd.AddValue ("traceFile", "Ns2 movement trace file", traceFile);
-
     nodos.Create (numNodos);
  
     for (uint32_t i = 0; i < numNodos; ++i)
@@ -162,39 +662,8 @@ AodvEjemplo::CrearNodos ()
         Names::Add (os.str (), nodos.Get (i));
     }
      
-    // Crear cuadricula estatica
-    MobilityHelper mobility;
-     
-    // Random Waypoint
-    double velocidadNodo = 20.0;
-    double tiempoPausa = 0.0;
-     
-    ObjectFactory of;
-    of.SetTypeId ("ns3::RandomRectanglePositionAllocator");
-    of.Set ("X", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=150.0]"));
-    of.Set ("Y", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=150.0]"));
-     
-    Ptr<PositionAllocator> pa = of.Create () -> GetObject<PositionAllocator> ();
- 
-    // Variable aleatoria uniforme de velocidad
-    std::ostringstream survs;
-    survs << "ns3::UniformRandomVariable[Min=0.0|Max=" << velocidadNodo << "]";
- 
-    // Variable aleatoria constante de pausa
-    std::ostringstream pcrvs;
-    pcrvs << "ns3::ConstantRandomVariable[Constant=" << tiempoPausa << "]";
- 
-    mobility.SetMobilityModel (
-        "ns3::RandomWaypointMobilityModel", 
-        "Speed", StringValue (survs.str ()),
-        "Pause", StringValue (pcrvs.str ()),
-        "PositionAllocator", PointerValue (pa)
-    );
-     
-    mobility.Install (nodos);
-
-    Ns2MobilityHelper ns2 = Ns2MobilityHelper (traceFile);
-    ns2.Install();
+    // Un solo modelo por nodo segun --movilidad
+    movilidad.Instalar (nodos);
 }
  
 void
@@ -202,20 +671,42 @@ AodvEjemplo::CrearDispositivos ()
 {   
     NqosWifiMacHelper wifiMac = NqosWifiMacHelper::Default ();
     wifiMac.SetType ("ns3::AdhocWifiMac");
-     
-    YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
-    YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default ();
-     
-    wifiPhy.SetChannel (wifiChannel.Create ()); 
+ 
     WifiHelper wifi;
     wifi.SetStandard (WIFI_PHY_STANDARD_80211b);
-     
-    dispositivos = wifi.Install (wifiPhy, wifiMac, nodos);
- 
-    if (pcap)
+
+    if (modoCanal == "yans")
     {
-        wifiPhy.EnablePcapAll (std::string ("graphs/UDP/100/aodv-ipv6"));
+        YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+        YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default ();
+        wifiPhy.Set ("TxPowerStart", DoubleValue (tesis::POTENCIA_TX));
+        wifiPhy.Set ("TxPowerEnd", DoubleValue (tesis::POTENCIA_TX));
+        wifiPhy.SetChannel (wifiChannel.Create ());
+        dispositivos = wifi.Install (wifiPhy, wifiMac, nodos);
+        return;
     }
+
+    // Mismos modelos que YansWifiChannelHelper::Default (): perdida
+    // log-distancia y retardo a velocidad constante
+    canalCuadricula = CreateObject<tesis::CanalCuadricula> ();
+    canalCuadricula->AddPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+    canalCuadricula->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+    if (modoCanal == "cuadricula" && !referenciaCanal)
+    {
+        // Por debajo del umbral de interferencia la senal ya no cambia el
+        // SINR ni el CCA
+        double umbral = tesis::UmbralInterferencia (margenCorte);
+        double corte = radioCorte > 0 ? radioCorte : tesis::DistanciaCorte (tesis::POTENCIA_TX, umbral);
+        canalCuadricula->SetAttribute ("DistanciaCorte", DoubleValue (corte));
+        canalCuadricula->SetAttribute ("Validar", BooleanValue (validarCanal));
+        canalCuadricula->SetAttribute ("UmbralValidacion", DoubleValue (umbral));
+    }
+
+    SpectrumWifiPhyHelper wifiPhy = SpectrumWifiPhyHelper::Default ();
+    wifiPhy.Set ("TxPowerStart", DoubleValue (tesis::POTENCIA_TX));
+    wifiPhy.Set ("TxPowerEnd", DoubleValue (tesis::POTENCIA_TX));
+    wifiPhy.SetChannel (canalCuadricula);
+    dispositivos = wifi.Install (wifiPhy, wifiMac, nodos);
 }
  
 void
@@ -239,12 +730,6 @@ AodvEjemplo::InstalarProtocolos ()
     // Adicional
     // interfaces.SetForwarding (0, true);
     // interfaces.SetDefaultRouteInAllNodes (0);
- 
-    if (imprimirRutas)
-    {
-        Ptr<OutputStreamWrapper> routingStream = Create<OutputStreamWrapper> ("graphs/UDP/100/aodv-ipv6.rutas", std::ios::out);
-        aodv.PrintRoutingTableAllAt (Seconds (8), routingStream);
-    }
 }
  
 void
@@ -256,40 +741,64 @@ AodvEjemplo::InstalarAplicaciones ()
     LogComponentEnable ("UdpClient", LOG_LEVEL_INFO);
     LogComponentEnable ("UdpServer", LOG_LEVEL_INFO);
 
-    Ptr<Node> nodeServer = nodos.Get(1);
-    Ptr<Node> nodeCliente = nodos.Get(80);
-    Ptr<Ipv6> ipv6Server = nodeServer->GetObject<Ipv6> ();
-    Ptr<Ipv6> ipv6Cliente = nodeCliente->GetObject<Ipv6> ();
-    Ipv6Address ipServer = ipv6Server->GetAddress( 1, 0 ).GetAddress();
-    Ipv6Address ipCliente = ipv6Cliente->GetAddress( 1, 0 ).GetAddress();
-    std::cout << "\tnodo 1:Server\n";
-    std::cout << ipServer; 
-    std::cout << "\n-----------\n";
-    std::cout << "\tnodo 80:Cliente\n";
-    std::cout << ipCliente;
-    std::cout << "\n-----------\n";
-  
-    UdpServerHelper server (port);
-    ApplicationContainer apps = server.Install (nodos.Get(1));
-    apps.Start (Seconds (19.0));
-    apps.Stop (Seconds (150.0));
-
-    UdpClientHelper client (Address(interfaces.GetAddress (1, 0)), port);
-    apps = client.Install (nodos.Get(80));
-    apps.Start (Seconds (20.0));
-    apps.Stop (Seconds (150.0));
+    // Un puerto por flujo: un nodo puede ser servidor de varios
+    for (uint32_t k = 0; k < flujos; ++k)
+    {
+        uint32_t desplazamiento = uint64_t (k) * numNodos / flujos;
+        uint32_t s = (servidor + desplazamiento) % numNodos;
+        uint32_t c = (cliente + desplazamiento) % numNodos;
+        // El puerto de AODV (654) se salta
+        uint16_t puerto = port + k + (port <= 654 && port + k >= 654 ? 1 : 0);
+
+        Ipv6Address ipServer = nodos.Get (s)->GetObject<Ipv6> ()->GetAddress (1, 0).GetAddress ();
+        Ipv6Address ipCliente = nodos.Get (c)->GetObject<Ipv6> ()->GetAddress (1, 0).GetAddress ();
+        std::cout << "\tnodo " << s << ":Server\n";
+        std::cout << ipServer;
+        std::cout << "\n-----------\n";
+        std::cout << "\tnodo " << c << ":Cliente\n";
+        std::cout << ipCliente;
+        std::cout << "\n-----------\n";
 
+        UdpServerHelper server (puerto);
+        ApplicationContainer apps = server.Install (nodos.Get (s));
+        apps.Start (Instante (19.0));
+        apps.Stop (Instante (150.0));
 
+        UdpClientHelper client (Address (interfaces.GetAddress (s, 0)), puerto);
+        if (varianteActual >= 0)
+        {
+            client.SetAttribute ("Interval", TimeValue (Seconds (variantes[varianteActual].intervalo)));
+            client.SetAttribute ("PacketSize", UintegerValue (variantes[varianteActual].tamano));
+        }
+        apps = client.Install (nodos.Get (c));
+        apps.Start (Instante (20.0));
+        apps.Stop (Instante (150.0));
+    }
 }
  
-int main (int argc, char *argv[])
+void
+AodvEjemplo::InstalarTrazas ()
 {
-    std::cout << "Ingrese número de nodos: \n";
-    std::cin >> nodo;
-
-    std::cout << "Ingrese tiempo total: \n";
-    std::cin >> tm;
+    // Se instalan despues de ramificar para que cada variante tenga sus
+    // propios archivos
+    if (pcap)
+    {
+        YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+        wifiPhy.EnablePcapAll (directorio + "/aodv-ipv6" + Sufijo ());
+    }
 
+    if (imprimirRutas)
+    {
+        Aodv6Helper aodv;
+        Ptr<OutputStreamWrapper> routingStream = Create<OutputStreamWrapper> (directorio + "/aodv-ipv6" + Sufijo () + ".rutas", std::ios::out);
+        // Si el calentamiento ya paso de los 8 s se imprime al ramificar
+        Time cuando = Simulator::Now () < Seconds (8) ? Instante (8) : Seconds (0);
+        aodv.PrintRoutingTableAllAt (cuando, routingStream);
+    }
+}
+ 
+int main (int argc, char *argv[])
+{
     AodvEjemplo ejemplo;
      
     if ( !ejemplo.Configurar (argc, argv) )
@@ -298,5 +807,6 @@ int main (int argc, char *argv[])
     }
      
     ejemplo.Ejecutar ();
+    ejemplo.Reporte (std::cout);
     return 0;
 }
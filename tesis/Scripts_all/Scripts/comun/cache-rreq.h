@@ -0,0 +1,196 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TESIS_CACHE_RREQ_H
+#define TESIS_CACHE_RREQ_H
+
+#include <cstdint>
+#include <vector>
+
+namespace tesis {
+
+/*
+ * Cache de RREQ duplicados (originador, id de RREQ) de memoria fija, para
+ * reemplazar el aodv::IdCache de cada nodo (un vector que se recorre entero
+ * para purgar y otra vez para buscar en cada RREQ escuchado).
+ *
+ * Los registros viven en un anillo de capacidad fija en orden de llegada;
+ * como todos duran lo mismo, ese es tambien el orden de vencimiento y
+ * purgar es sacar de la cabeza. Un arreglo de ranuras (potencia de dos,
+ * carga <= 1/2, sondeo lineal, borrado corriendo hacia atras como en
+ * TablaRutas6) indexa el anillo por originador e id.
+ *
+ * Las claves se comparan enteras, asi que mientras no se desaloje nada
+ * las respuestas son las de IdCache. Con el anillo lleno se desaloja el
+ * registro mas viejo antes de tiempo: una copia posterior de ese RREQ se
+ * toma por nueva (se reenvia, como sin cache) y su registro vuelve a
+ * empezar, asi que una copia que llegue mas de vida despues de la primera
+ * puede tomarse por duplicada. Los dos errores quedan acotados por
+ * GetDesalojos, que es 0 mientras la capacidad alcance para las
+ * inundaciones que se escuchan en vida (tasa x PathDiscoveryTime).
+ *
+ * El originador es el identificador de su direccion en Internador6 y el
+ * tiempo, pasos enteros del simulador (Time::GetTimeStep), que no bajan
+ * entre llamadas.
+ */
+class CacheRreq
+{
+public:
+    // vida: PathDiscoveryTime en pasos del simulador
+    CacheRreq (uint32_t capacidad, int64_t vida);
+
+    // true si el RREQ (originador, id) ya se escucho y sigue vigente en
+    // ahora; si no, lo registra hasta ahora + vida (IdCache::IsDuplicate)
+    bool EsDuplicado (uint32_t originador, uint32_t id, int64_t ahora);
+
+    // Registros vigentes en ahora
+    uint32_t size (int64_t ahora);
+
+    uint32_t GetCapacidad () const { return m_anillo.size (); }
+
+    // Registros desalojados antes de vencer por falta de lugar
+    uint64_t GetDesalojos () const { return m_desalojos; }
+
+    // Bytes reservados; no cambian despues de construirla
+    uint64_t GetMemoria () const;
+
+private:
+    struct Registro
+    {
+        uint64_t clave;
+        int64_t vencimiento;
+    };
+
+    static uint64_t Clave (uint32_t originador, uint32_t id);
+    // Ranura de la clave, o la libre donde iria
+    uint32_t Ubicar (uint64_t clave) const;
+    uint32_t Inicial (uint64_t clave) const;
+    void Purgar (int64_t ahora);
+    void SacarCabeza ();
+
+    std::vector<Registro> m_anillo;
+    uint32_t m_cabeza;
+    uint32_t m_cantidad;
+    // Posicion en el anillo + 1 (0 = libre)
+    std::vector<uint32_t> m_ranuras;
+    uint32_t m_mascara;
+    int64_t m_vida;
+    uint64_t m_desalojos;
+};
+
+inline
+CacheRreq::CacheRreq (uint32_t capacidad, int64_t vida)
+  : m_anillo (capacidad > 0 ? capacidad : 1),
+    m_cabeza (0),
+    m_cantidad (0),
+    m_vida (vida),
+    m_desalojos (0)
+{
+    uint32_t ranuras = 4;
+    while (ranuras < 2 * m_anillo.size ())
+    {
+        ranuras *= 2;
+    }
+    m_ranuras.assign (ranuras, 0);
+    m_mascara = ranuras - 1;
+}
+
+inline uint64_t
+CacheRreq::Clave (uint32_t originador, uint32_t id)
+{
+    return (uint64_t (originador) << 32) | id;
+}
+
+inline uint32_t
+CacheRreq::Inicial (uint64_t clave) const
+{
+    uint64_t h = clave * 0x9E3779B97F4A7C15ULL;
+    return uint32_t ((h ^ (h >> 29)) >> 32) & m_mascara;
+}
+
+inline uint32_t
+CacheRreq::Ubicar (uint64_t clave) const
+{
+    uint32_t r = Inicial (clave);
+    while (m_ranuras[r] != 0 && m_anillo[m_ranuras[r] - 1].clave != clave)
+    {
+        r = (r + 1) & m_mascara;
+    }
+    return r;
+}
+
+inline void
+CacheRreq::SacarCabeza ()
+{
+    uint32_t libre = Ubicar (m_anillo[m_cabeza].clave);
+    m_cabeza = m_cabeza + 1 == m_anillo.size () ? 0 : m_cabeza + 1;
+    --m_cantidad;
+
+    // Correr hacia atras las ranuras que quedarian inalcanzables detras
+    // del hueco
+    uint32_t s = (libre + 1) & m_mascara;
+    while (m_ranuras[s] != 0)
+    {
+        uint32_t inicial = Inicial (m_anillo[m_ranuras[s] - 1].clave);
+        if (((s - inicial) & m_mascara) >= ((s - libre) & m_mascara))
+        {
+            m_ranuras[libre] = m_ranuras[s];
+            libre = s;
+        }
+        s = (s + 1) & m_mascara;
+    }
+    m_ranuras[libre] = 0;
+}
+
+inline void
+CacheRreq::Purgar (int64_t ahora)
+{
+    while (m_cantidad > 0 && m_anillo[m_cabeza].vencimiento < ahora)
+    {
+        SacarCabeza ();
+    }
+}
+
+inline bool
+CacheRreq::EsDuplicado (uint32_t originador, uint32_t id, int64_t ahora)
+{
+    Purgar (ahora);
+    uint64_t clave = Clave (originador, id);
+    uint32_t r = Ubicar (clave);
+    if (m_ranuras[r] != 0)
+    {
+        return true;
+    }
+    if (m_cantidad == m_anillo.size ())
+    {
+        SacarCabeza ();
+        ++m_desalojos;
+        r = Ubicar (clave);
+    }
+    uint32_t posicion = m_cabeza + m_cantidad;
+    if (posicion >= m_anillo.size ())
+    {
+        posicion -= m_anillo.size ();
+    }
+    m_anillo[posicion].clave = clave;
+    m_anillo[posicion].vencimiento = ahora + m_vida;
+    m_ranuras[r] = posicion + 1;
+    ++m_cantidad;
+    return false;
+}
+
+inline uint32_t
+CacheRreq::size (int64_t ahora)
+{
+    Purgar (ahora);
+    return m_cantidad;
+}
+
+inline uint64_t
+CacheRreq::GetMemoria () const
+{
+    return m_anillo.capacity () * sizeof (Registro) + m_ranuras.capacity () * sizeof (uint32_t);
+}
+
+} // namespace tesis
+
+#endif /* TESIS_CACHE_RREQ_H */
@@ -0,0 +1,437 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TESIS_CANAL_CUADRICULA_H
+#define TESIS_CANAL_CUADRICULA_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/propagation-module.h"
+#include "ns3/spectrum-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace tesis {
+
+// Potencia de transmision de los scripts, dBm (TxPowerStart y TxPowerEnd
+// por defecto de WifiPhy); la misma fija la PHY y da el radio de corte
+const double POTENCIA_TX = 16.0206;
+
+// Distancia a la que la potencia recibida cae por debajo de umbralDbm con
+// un modelo log-distancia (valores por defecto de YansWifiChannelHelper)
+inline double
+DistanciaCorte (double txDbm, double umbralDbm,
+                double exponente = 3.0, double perdidaReferenciaDb = 46.6777,
+                double distanciaReferencia = 1.0)
+{
+    return distanciaReferencia *
+        std::pow (10.0, (txDbm - umbralDbm - perdidaReferenciaDb) / (10.0 * exponente));
+}
+
+// Ruido termico (kT a 290 K) mas la figura de ruido del receptor, dBm; por
+// defecto el canal de 22 MHz de 802.11b y RxNoiseFigure de WifiPhy
+inline double
+PisoRuido (double anchoBandaHz = 22e6, double figuraRuidoDb = 7.0)
+{
+    return 10.0 * std::log10 (1.3803e-23 * 290.0 * anchoBandaHz * 1000.0) + figuraRuidoDb;
+}
+
+// Potencia por debajo de la cual se puede dejar de entregar una senal. No
+// alcanza con el umbral de deteccion (EnergyDetectionThreshold, -96 dBm):
+// toda senal entregada suma interferencia al SINR y energia a la deteccion
+// de canal ocupado (CcaMode1Threshold, -99 dBm). El umbral queda margenDb
+// por debajo del menor entre el piso de ruido y el de CCA
+inline double
+UmbralInterferencia (double margenDb = 20.0, double ccaDbm = -99.0)
+{
+    return std::min (PisoRuido (), ccaDbm) - margenDb;
+}
+
+/*
+ * Canal de un solo modelo espectral que solo evalua los receptores a menos
+ * de DistanciaCorte del transmisor.
+ *
+ * Los nodos se guardan en una cuadricula uniforme de celdas de
+ * DistanciaCorte de lado. La cuadricula se reconstruye cuando algun nodo
+ * cambia de rumbo (CourseChange; MovilidadTrayectoria solo lo dispara con
+ * NotificarRumbo=true) o cuando el desplazamiento maximo posible desde la ultima
+ * reconstruccion supera un cuarto de celda. Entre reconstrucciones cada
+ * nodo se mueve a velocidad constante, asi que basta ampliar la busqueda en
+ * velocidadMaxima * tiempo transcurrido y filtrar por la distancia real.
+ *
+ * Con DistanciaCorte infinita se comporta como SingleModelSpectrumChannel
+ * (difusion a todos). Para no cambiar los resultados el corte tiene que
+ * salir de UmbralInterferencia y no del alcance del radio; con 16 dBm y
+ * 20 dB de margen son unos 880 m, asi que solo recorta en los escenarios
+ * grandes. Con Validar=true ademas calcula la potencia de cada receptor
+ * descartado y cuenta los que hubieran superado UmbralValidacion; la
+ * comparacion de resultados contra el canal completo la hacen los scripts
+ * (--validarCanal).
+ */
+class CanalCuadricula : public ns3::SpectrumChannel
+{
+public:
+    static ns3::TypeId GetTypeId ();
+
+    CanalCuadricula ();
+
+    virtual void AddRx (ns3::Ptr<ns3::SpectrumPhy> phy);
+    virtual void StartTx (ns3::Ptr<ns3::SpectrumSignalParameters> params);
+    virtual void AddPropagationLossModel (ns3::Ptr<ns3::PropagationLossModel> perdida);
+    virtual void AddSpectrumPropagationLossModel (ns3::Ptr<ns3::SpectrumPropagationLossModel> perdida);
+    virtual void SetPropagationDelayModel (ns3::Ptr<ns3::PropagationDelayModel> retardo);
+    virtual ns3::Ptr<ns3::SpectrumPropagationLossModel> GetSpectrumPropagationLossModel ();
+    virtual uint32_t GetNDevices () const;
+    virtual ns3::Ptr<ns3::NetDevice> GetDevice (uint32_t i) const;
+
+    // Receptores evaluados, descartados y descartes que superaban el umbral
+    void Reporte (std::ostream &os) const;
+
+protected:
+    virtual void DoDispose ();
+
+private:
+    typedef std::pair<int32_t, int32_t> Celda;
+
+    Celda CeldaDe (const ns3::Vector &p) const;
+    void CambioDeRumbo (ns3::Ptr<const ns3::MobilityModel> modelo);
+    void Reconstruir ();
+    bool DebeReconstruir () const;
+    void Entregar (ns3::Ptr<ns3::SpectrumSignalParameters> tx, ns3::Ptr<ns3::SpectrumPhy> rx,
+                   ns3::Ptr<ns3::MobilityModel> origen, ns3::Ptr<ns3::MobilityModel> destino);
+    void Validar (ns3::Ptr<ns3::SpectrumSignalParameters> tx, ns3::Ptr<ns3::SpectrumPhy> rx,
+                  ns3::Ptr<ns3::MobilityModel> origen, ns3::Ptr<ns3::MobilityModel> destino);
+    static void StartRx (ns3::Ptr<ns3::SpectrumSignalParameters> params, ns3::Ptr<ns3::SpectrumPhy> rx);
+
+    std::vector<ns3::Ptr<ns3::SpectrumPhy> > m_phys;
+    std::vector<bool> m_conectado;
+    std::map<Celda, std::vector<uint32_t> > m_celdas;
+    bool m_sucia;
+    ns3::Time m_construida;
+    double m_velocidadMaxima;
+
+    ns3::Ptr<ns3::PropagationLossModel> m_perdida;
+    ns3::Ptr<ns3::SpectrumPropagationLossModel> m_perdidaEspectral;
+    ns3::Ptr<ns3::PropagationDelayModel> m_retardo;
+
+    double m_corte;
+    bool m_validar;
+    double m_umbralValidacion;
+
+    uint64_t m_evaluados;
+    uint64_t m_candidatos;
+    uint64_t m_discrepancias;
+    uint64_t m_reconstrucciones;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (CanalCuadricula);
+
+inline ns3::TypeId
+CanalCuadricula::GetTypeId ()
+{
+    static ns3::TypeId tid = ns3::TypeId ("tesis::CanalCuadricula")
+        .SetParent<ns3::SpectrumChannel> ()
+        .AddConstructor<CanalCuadricula> ()
+        .AddAttribute ("DistanciaCorte",
+                       "Distancia maxima (m) a la que se evaluan receptores.",
+                       ns3::DoubleValue (std::numeric_limits<double>::infinity ()),
+                       ns3::MakeDoubleAccessor (&CanalCuadricula::m_corte),
+                       ns3::MakeDoubleChecker<double> (0.0))
+        .AddAttribute ("Validar",
+                       "Calcular la potencia de los receptores descartados.",
+                       ns3::BooleanValue (false),
+                       ns3::MakeBooleanAccessor (&CanalCuadricula::m_validar),
+                       ns3::MakeBooleanChecker ())
+        .AddAttribute ("UmbralValidacion",
+                       "Potencia (dBm) por encima de la cual un descarte es una discrepancia.",
+                       ns3::DoubleValue (UmbralInterferencia ()),
+                       ns3::MakeDoubleAccessor (&CanalCuadricula::m_umbralValidacion),
+                       ns3::MakeDoubleChecker<double> ());
+    return tid;
+}
+
+inline
+CanalCuadricula::CanalCuadricula ()
+  : m_sucia (true),
+    m_velocidadMaxima (0),
+    m_corte (std::numeric_limits<double>::infinity ()),
+    m_validar (false),
+    m_umbralValidacion (UmbralInterferencia ()),
+    m_evaluados (0),
+    m_candidatos (0),
+    m_discrepancias (0),
+    m_reconstrucciones (0)
+{
+}
+
+inline void
+CanalCuadricula::DoDispose ()
+{
+    m_phys.clear ();
+    m_celdas.clear ();
+    m_perdida = 0;
+    m_perdidaEspectral = 0;
+    m_retardo = 0;
+    ns3::SpectrumChannel::DoDispose ();
+}
+
+inline void
+CanalCuadricula::AddRx (ns3::Ptr<ns3::SpectrumPhy> phy)
+{
+    m_phys.push_back (phy);
+    m_conectado.push_back (false);
+    m_sucia = true;
+}
+
+inline void
+CanalCuadricula::AddPropagationLossModel (ns3::Ptr<ns3::PropagationLossModel> perdida)
+{
+    NS_ASSERT (m_perdida == 0);
+    m_perdida = perdida;
+}
+
+inline void
+CanalCuadricula::AddSpectrumPropagationLossModel (ns3::Ptr<ns3::SpectrumPropagationLossModel> perdida)
+{
+    NS_ASSERT (m_perdidaEspectral == 0);
+    m_perdidaEspectral = perdida;
+}
+
+inline void
+CanalCuadricula::SetPropagationDelayModel (ns3::Ptr<ns3::PropagationDelayModel> retardo)
+{
+    NS_ASSERT (m_retardo == 0);
+    m_retardo = retardo;
+}
+
+inline ns3::Ptr<ns3::SpectrumPropagationLossModel>
+CanalCuadricula::GetSpectrumPropagationLossModel ()
+{
+    return m_perdidaEspectral;
+}
+
+inline uint32_t
+CanalCuadricula::GetNDevices () const
+{
+    return m_phys.size ();
+}
+
+inline ns3::Ptr<ns3::NetDevice>
+CanalCuadricula::GetDevice (uint32_t i) const
+{
+    return m_phys[i]->GetDevice ()->GetObject<ns3::NetDevice> ();
+}
+
+inline CanalCuadricula::Celda
+CanalCuadricula::CeldaDe (const ns3::Vector &p) const
+{
+    return Celda (int32_t (std::floor (p.x / m_corte)), int32_t (std::floor (p.y / m_corte)));
+}
+
+inline void
+CanalCuadricula::CambioDeRumbo (ns3::Ptr<const ns3::MobilityModel>)
+{
+    m_sucia = true;
+}
+
+inline bool
+CanalCuadricula::DebeReconstruir () const
+{
+    double desplazamiento = m_velocidadMaxima * (ns3::Simulator::Now () - m_construida).GetSeconds ();
+    return m_sucia || desplazamiento > m_corte / 4;
+}
+
+inline void
+CanalCuadricula::Reconstruir ()
+{
+    m_celdas.clear ();
+    m_velocidadMaxima = 0;
+    for (uint32_t i = 0; i < m_phys.size (); ++i)
+    {
+        ns3::Ptr<ns3::MobilityModel> movilidad = m_phys[i]->GetMobility ();
+        if (movilidad == 0)
+        {
+            continue;
+        }
+        // La movilidad se asigna al PHY despues de AddRx
+        if (!m_conectado[i])
+        {
+            movilidad->TraceConnectWithoutContext (
+                "CourseChange", ns3::MakeCallback (&CanalCuadricula::CambioDeRumbo, this));
+            m_conectado[i] = true;
+        }
+        ns3::Vector v = movilidad->GetVelocity ();
+        m_velocidadMaxima = std::max (m_velocidadMaxima, std::sqrt (v.x * v.x + v.y * v.y + v.z * v.z));
+        m_celdas[CeldaDe (movilidad->GetPosition ())].push_back (i);
+    }
+    m_construida = ns3::Simulator::Now ();
+    m_sucia = false;
+    ++m_reconstrucciones;
+}
+
+inline void
+CanalCuadricula::StartTx (ns3::Ptr<ns3::SpectrumSignalParameters> params)
+{
+    NS_ASSERT_MSG (params->psd, "PSD nula");
+    ns3::Ptr<ns3::MobilityModel> origen = params->txPhy->GetMobility ();
+    m_candidatos += m_phys.size () - 1;
+
+    // Sin corte o sin posicion: difusion a todos, como SingleModelSpectrumChannel
+    if (std::isinf (m_corte) || origen == 0)
+    {
+        for (uint32_t i = 0; i < m_phys.size (); ++i)
+        {
+            if (m_phys[i] != params->txPhy)
+            {
+                ++m_evaluados;
+                Entregar (params, m_phys[i], origen, m_phys[i]->GetMobility ());
+            }
+        }
+        return;
+    }
+
+    if (DebeReconstruir ())
+    {
+        Reconstruir ();
+    }
+
+    ns3::Vector p = origen->GetPosition ();
+    double holgura = m_velocidadMaxima * (ns3::Simulator::Now () - m_construida).GetSeconds ();
+    double radio = m_corte + holgura;
+    int32_t alcance = int32_t (std::ceil (radio / m_corte));
+    Celda centro = CeldaDe (p);
+
+    std::vector<bool> visto (m_validar ? m_phys.size () : 0, false);
+    for (int32_t dx = -alcance; dx <= alcance; ++dx)
+    {
+        for (int32_t dy = -alcance; dy <= alcance; ++dy)
+        {
+            std::map<Celda, std::vector<uint32_t> >::const_iterator celda =
+                m_celdas.find (Celda (centro.first + dx, centro.second + dy));
+            if (celda == m_celdas.end ())
+            {
+                continue;
+            }
+            for (uint32_t i : celda->second)
+            {
+                if (m_phys[i] == params->txPhy)
+                {
+                    continue;
+                }
+                ns3::Ptr<ns3::MobilityModel> destino = m_phys[i]->GetMobility ();
+                if (origen->GetDistanceFrom (destino) > m_corte)
+                {
+                    continue;
+                }
+                if (m_validar)
+                {
+                    visto[i] = true;
+                }
+                ++m_evaluados;
+                Entregar (params, m_phys[i], origen, destino);
+            }
+        }
+    }
+
+    if (m_validar)
+    {
+        for (uint32_t i = 0; i < m_phys.size (); ++i)
+        {
+            if (!visto[i] && m_phys[i] != params->txPhy)
+            {
+                Validar (params, m_phys[i], origen, m_phys[i]->GetMobility ());
+            }
+        }
+    }
+}
+
+inline void
+CanalCuadricula::Entregar (ns3::Ptr<ns3::SpectrumSignalParameters> tx, ns3::Ptr<ns3::SpectrumPhy> rx,
+                           ns3::Ptr<ns3::MobilityModel> origen, ns3::Ptr<ns3::MobilityModel> destino)
+{
+    ns3::Ptr<ns3::SpectrumSignalParameters> params = tx->Copy ();
+    ns3::Time retardo = ns3::Seconds (0);
+    if (origen != 0 && destino != 0)
+    {
+        double perdidaDb = 0;
+        if (tx->txAntenna != 0)
+        {
+            perdidaDb -= tx->txAntenna->GetGainDb (destino->GetPosition ());
+        }
+        ns3::Ptr<ns3::AntennaModel> antena = rx->GetRxAntenna ();
+        if (antena != 0)
+        {
+            perdidaDb -= antena->GetGainDb (origen->GetPosition ());
+        }
+        if (m_perdida != 0)
+        {
+            perdidaDb -= m_perdida->CalcRxPower (0, origen, destino);
+        }
+        *(params->psd) *= std::pow (10.0, -perdidaDb / 10.0);
+        if (m_perdidaEspectral != 0)
+        {
+            params->psd = m_perdidaEspectral->CalcRxPowerSpectralDensity (params->psd, origen, destino);
+        }
+        if (m_retardo != 0)
+        {
+            retardo = m_retardo->GetDelay (origen, destino);
+        }
+    }
+
+    ns3::Ptr<ns3::NetDevice> dispositivo = rx->GetDevice () ? rx->GetDevice ()->GetObject<ns3::NetDevice> () : 0;
+    if (dispositivo != 0)
+    {
+        ns3::Simulator::ScheduleWithContext (dispositivo->GetNode ()->GetId (), retardo,
+                                             &CanalCuadricula::StartRx, params, rx);
+    }
+    else
+    {
+        ns3::Simulator::Schedule (retardo, &CanalCuadricula::StartRx, params, rx);
+    }
+}
+
+inline void
+CanalCuadricula::Validar (ns3::Ptr<ns3::SpectrumSignalParameters> tx, ns3::Ptr<ns3::SpectrumPhy>,
+                          ns3::Ptr<ns3::MobilityModel> origen, ns3::Ptr<ns3::MobilityModel> destino)
+{
+    if (m_perdida == 0 || destino == 0)
+    {
+        return;
+    }
+    double txDbm = 10.0 * std::log10 (ns3::Integral (*tx->psd) * 1000.0);
+    if (m_perdida->CalcRxPower (txDbm, origen, destino) >= m_umbralValidacion)
+    {
+        ++m_discrepancias;
+    }
+}
+
+inline void
+CanalCuadricula::StartRx (ns3::Ptr<ns3::SpectrumSignalParameters> params, ns3::Ptr<ns3::SpectrumPhy> rx)
+{
+    rx->StartRx (params);
+}
+
+inline void
+CanalCuadricula::Reporte (std::ostream &os) const
+{
+    uint64_t descartados = m_candidatos - m_evaluados;
+    os << "Canal: corte " << m_corte << " m, "
+       << m_evaluados << " receptores evaluados, "
+       << descartados << " descartados, "
+       << m_reconstrucciones << " reconstrucciones de la cuadricula";
+    if (m_validar)
+    {
+        os << ", " << m_discrepancias << " descartes sobre " << m_umbralValidacion << " dBm";
+    }
+    os << "\n";
+}
+
+} // namespace tesis
+
+#endif /* TESIS_CANAL_CUADRICULA_H */
@@ -0,0 +1,350 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TESIS_COLA_PEDIDOS_H
+#define TESIS_COLA_PEDIDOS_H
+
+#include "tabla-rutas6.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <vector>
+
+namespace tesis {
+
+// Contadores de las colas de pedidos de toda la simulacion; los imprime
+// herramientas/cola-pedidos, los scripts todavia no usan ColaPedidos
+class EstadisticaColas
+{
+public:
+    // La de la simulacion en curso
+    static EstadisticaColas &Global ();
+
+    EstadisticaColas ();
+
+    void Encolado (uint32_t profundidad);
+    void Entregado (int64_t espera);
+    void Vencido () { ++m_vencidos; }
+    void Desborde () { ++m_desbordes; }
+    void Descartado () { ++m_descartados; }
+    void Duplicado () { ++m_duplicados; }
+
+    uint64_t GetEncolados () const { return m_encolados; }
+
+    // pasos: pasos del simulador por segundo, para las esperas
+    void Reporte (std::ostream &os, double pasos = 1e9) const;
+
+    void clear ();
+
+private:
+    uint64_t m_encolados;
+    uint64_t m_entregados;
+    uint64_t m_vencidos;
+    uint64_t m_desbordes;
+    uint64_t m_descartados;
+    uint64_t m_duplicados;
+    uint32_t m_profundidadMaxima;
+    double m_sumaProfundidad;
+    double m_sumaEspera;
+};
+
+/*
+ * Cola de paquetes que esperan el descubrimiento de una ruta, como la
+ * aodv::RequestQueue (maximo de paquetes por nodo, descarte del mas viejo
+ * al llenarse, vencimiento tras una espera fija, rechazo de un paquete ya
+ * encolado para el mismo destino), sin recorrerla entera en cada RREP,
+ * descarte o vencimiento.
+ *
+ * Las entradas viven en un arreglo fijo de maximo nodos con una lista
+ * libre. Una lista doblemente enlazada las ordena por llegada, que con
+ * espera fija es el orden de vencimiento: purgar y descartar el mas viejo
+ * es sacar de la cabeza. Cada destino (su identificador en Internador6)
+ * tiene ademas su cubo FIFO en una TablaRutas6, asi que entregar el primer
+ * paquete de un destino es O(1) y descartar los de un destino cuesta lo
+ * que tiene su cubo. El mas viejo de la cola es siempre el primero de su
+ * cubo, por eso al cubo le basta un enlace hacia adelante.
+ *
+ * Los tiempos son pasos enteros del simulador (Time::GetTimeStep), que no
+ * bajan entre llamadas; como en RequestQueue, una entrada vence cuando su
+ * vencimiento queda antes de ahora. Descartar un paquete (vencido, por
+ * desborde o por destino) llama a la funcion de SetDescartar, que en el
+ * port invoca la ErrorCallback de la entrada.
+ */
+template <typename Paquete>
+class ColaPedidos
+{
+public:
+    typedef std::function<void (const Paquete &)> Descartar;
+
+    // espera: QueueTimeout en pasos del simulador
+    ColaPedidos (uint32_t maximo, int64_t espera, EstadisticaColas *estadistica = &EstadisticaColas::Global ());
+
+    void SetDescartar (Descartar descartar) { m_descartar = descartar; }
+
+    // Encola el paquete (uid: Packet::GetUid) para destino; false si ya
+    // habia uno con el mismo uid para el mismo destino
+    bool Encolar (uint32_t destino, uint64_t uid, const Paquete &paquete, int64_t ahora);
+
+    // Saca el primer paquete para destino
+    bool Desencolar (uint32_t destino, Paquete &paquete, int64_t ahora);
+
+    // Descarta todos los paquetes para destino
+    void DescartarDestino (uint32_t destino, int64_t ahora);
+
+    // Si hay paquetes para destino (sin purgar, como RequestQueue::Find)
+    bool Contiene (uint32_t destino) const { return m_cubos.Buscar (destino) != 0; }
+
+    uint32_t size (int64_t ahora);
+
+private:
+    static const uint32_t NINGUNO = 0xffffffff;
+
+    struct Nodo
+    {
+        Paquete paquete;
+        uint64_t uid;
+        int64_t vencimiento;
+        uint32_t destino;
+        // Orden de llegada (siguiente tambien encadena la lista libre)
+        uint32_t anterior;
+        uint32_t siguiente;
+        uint32_t siguienteDestino;
+    };
+
+    struct Cubo
+    {
+        uint32_t primero;
+        uint32_t ultimo;
+    };
+
+    void Purgar (int64_t ahora);
+    // Saca el primero de su cubo y lo devuelve a la lista libre
+    void Quitar (uint32_t i);
+
+    std::vector<Nodo> m_nodos;
+    uint32_t m_libres;
+    uint32_t m_primero;
+    uint32_t m_ultimo;
+    uint32_t m_cantidad;
+    TablaRutas6<Cubo, uint32_t> m_cubos;
+    int64_t m_espera;
+    Descartar m_descartar;
+    EstadisticaColas *m_estadistica;
+};
+
+inline EstadisticaColas &
+EstadisticaColas::Global ()
+{
+    static EstadisticaColas global;
+    return global;
+}
+
+inline
+EstadisticaColas::EstadisticaColas ()
+{
+    clear ();
+}
+
+inline void
+EstadisticaColas::Encolado (uint32_t profundidad)
+{
+    ++m_encolados;
+    m_profundidadMaxima = std::max (m_profundidadMaxima, profundidad);
+    m_sumaProfundidad += profundidad;
+}
+
+inline void
+EstadisticaColas::Entregado (int64_t espera)
+{
+    ++m_entregados;
+    m_sumaEspera += espera;
+}
+
+inline void
+EstadisticaColas::Reporte (std::ostream &os, double pasos) const
+{
+    os << "Colas de pedidos: " << m_encolados << " encolados, " << m_entregados << " entregados"
+       << " (espera media " << (m_entregados > 0 ? m_sumaEspera / m_entregados / pasos : 0.0) << " s), "
+       << m_vencidos << " vencidos, " << m_desbordes << " por desborde, " << m_descartados
+       << " por destino, " << m_duplicados << " duplicados rechazados, profundidad media "
+       << (m_encolados > 0 ? m_sumaProfundidad / m_encolados : 0.0) << " y maxima "
+       << m_profundidadMaxima << "\n";
+}
+
+inline void
+EstadisticaColas::clear ()
+{
+    m_encolados = 0;
+    m_entregados = 0;
+    m_vencidos = 0;
+    m_desbordes = 0;
+    m_descartados = 0;
+    m_duplicados = 0;
+    m_profundidadMaxima = 0;
+    m_sumaProfundidad = 0;
+    m_sumaEspera = 0;
+}
+
+template <typename Paquete>
+ColaPedidos<Paquete>::ColaPedidos (uint32_t maximo, int64_t espera, EstadisticaColas *estadistica)
+  : m_nodos (maximo > 0 ? maximo : 1),
+    m_libres (0),
+    m_primero (NINGUNO),
+    m_ultimo (NINGUNO),
+    m_cantidad (0),
+    m_espera (espera),
+    m_estadistica (estadistica)
+{
+    for (uint32_t i = 0; i < m_nodos.size (); ++i)
+    {
+        m_nodos[i].siguiente = i + 1 < m_nodos.size () ? i + 1 : NINGUNO;
+    }
+}
+
+template <typename Paquete>
+void
+ColaPedidos<Paquete>::Quitar (uint32_t i)
+{
+    Nodo &n = m_nodos[i];
+
+    Cubo *cubo = m_cubos.Buscar (n.destino);
+    if (n.siguienteDestino == NINGUNO)
+    {
+        m_cubos.Borrar (n.destino);
+    }
+    else
+    {
+        cubo->primero = n.siguienteDestino;
+    }
+
+    (n.anterior != NINGUNO ? m_nodos[n.anterior].siguiente : m_primero) = n.siguiente;
+    (n.siguiente != NINGUNO ? m_nodos[n.siguiente].anterior : m_ultimo) = n.anterior;
+
+    // Soltar el paquete (y sus Ptr) ya, no cuando se reutilice el nodo
+    n.paquete = Paquete ();
+    n.siguiente = m_libres;
+    m_libres = i;
+    --m_cantidad;
+}
+
+template <typename Paquete>
+void
+ColaPedidos<Paquete>::Purgar (int64_t ahora)
+{
+    while (m_primero != NINGUNO && m_nodos[m_primero].vencimiento < ahora)
+    {
+        uint32_t i = m_primero;
+        Paquete paquete = m_nodos[i].paquete;
+        Quitar (i);
+        m_estadistica->Vencido ();
+        if (m_descartar)
+        {
+            m_descartar (paquete);
+        }
+    }
+}
+
+template <typename Paquete>
+bool
+ColaPedidos<Paquete>::Encolar (uint32_t destino, uint64_t uid, const Paquete &paquete, int64_t ahora)
+{
+    Purgar (ahora);
+    const Cubo *cubo = m_cubos.Buscar (destino);
+    for (uint32_t i = cubo != 0 ? cubo->primero : NINGUNO; i != NINGUNO; i = m_nodos[i].siguienteDestino)
+    {
+        if (m_nodos[i].uid == uid)
+        {
+            m_estadistica->Duplicado ();
+            return false;
+        }
+    }
+    if (m_libres == NINGUNO)
+    {
+        // Llena: se descarta el mas viejo
+        uint32_t i = m_primero;
+        Paquete viejo = m_nodos[i].paquete;
+        Quitar (i);
+        m_estadistica->Desborde ();
+        if (m_descartar)
+        {
+            m_descartar (viejo);
+        }
+    }
+
+    uint32_t i = m_libres;
+    Nodo &n = m_nodos[i];
+    m_libres = n.siguiente;
+    n.paquete = paquete;
+    n.uid = uid;
+    n.vencimiento = ahora + m_espera;
+    n.destino = destino;
+    n.anterior = m_ultimo;
+    n.siguiente = NINGUNO;
+    n.siguienteDestino = NINGUNO;
+    (m_ultimo != NINGUNO ? m_nodos[m_ultimo].siguiente : m_primero) = i;
+    m_ultimo = i;
+
+    Cubo *ultimo = m_cubos.Buscar (destino);
+    if (ultimo != 0)
+    {
+        m_nodos[ultimo->ultimo].siguienteDestino = i;
+        ultimo->ultimo = i;
+    }
+    else
+    {
+        Cubo nuevo = { i, i };
+        m_cubos.Agregar (destino, nuevo);
+    }
+    ++m_cantidad;
+    m_estadistica->Encolado (m_cantidad);
+    return true;
+}
+
+template <typename Paquete>
+bool
+ColaPedidos<Paquete>::Desencolar (uint32_t destino, Paquete &paquete, int64_t ahora)
+{
+    Purgar (ahora);
+    const Cubo *cubo = m_cubos.Buscar (destino);
+    if (cubo == 0)
+    {
+        return false;
+    }
+    uint32_t i = cubo->primero;
+    paquete = m_nodos[i].paquete;
+    m_estadistica->Entregado (ahora - (m_nodos[i].vencimiento - m_espera));
+    Quitar (i);
+    return true;
+}
+
+template <typename Paquete>
+void
+ColaPedidos<Paquete>::DescartarDestino (uint32_t destino, int64_t ahora)
+{
+    Purgar (ahora);
+    const Cubo *cubo;
+    while ((cubo = m_cubos.Buscar (destino)) != 0)
+    {
+        uint32_t i = cubo->primero;
+        Paquete paquete = m_nodos[i].paquete;
+        Quitar (i);
+        m_estadistica->Descartado ();
+        if (m_descartar)
+        {
+            m_descartar (paquete);
+        }
+    }
+}
+
+template <typename Paquete>
+uint32_t
+ColaPedidos<Paquete>::size (int64_t ahora)
+{
+    Purgar (ahora);
+    return m_cantidad;
+}
+
+} // namespace tesis
+
+#endif /* TESIS_COLA_PEDIDOS_H */
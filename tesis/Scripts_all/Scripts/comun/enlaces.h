@@ -0,0 +1,544 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TESIS_ENLACES_H
+#define TESIS_ENLACES_H
+
+#include "trayectorias.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tesis {
+
+// Intervalo [desde, hasta) en que los nodos a < b estan a distancia <= alcance
+struct Enlace
+{
+    uint32_t a;
+    uint32_t b;
+    double desde;
+    double hasta;
+};
+
+/*
+ * Linea de tiempo de disponibilidad de enlaces de un escenario: para cada
+ * par de nodos, los intervalos exactos en que estan dentro del radio de
+ * alcance.
+ *
+ * Dentro de un tramo comun a los dos nodos la posicion relativa es lineal,
+ * asi que la distancia al cuadrado es una cuadratica en t y los instantes
+ * de subida y caida salen de sus raices, sin muestrear. Para no probar los
+ * N^2 pares, el tiempo se divide en ventanas; en cada una se toma la caja
+ * que recorre cada nodo y se guarda en una cuadricula de celdas de lado
+ * alcance, y solo se resuelven los pares cuyas cajas quedan a menos del
+ * alcance. Los nodos se reparten entre hilos (a intercalado) y los
+ * intervalos que se tocan en el borde de una ventana se unen al final.
+ *
+ * Formato binario (.enl), en el orden de bytes de la maquina:
+ *
+ *   "TESISENL"  uint32 version  uint32 nodos
+ *   double alcance  double duracion  uint64 enlaces
+ *   Enlace enlaces[enlaces]     ordenados por (a, b, desde)
+ */
+class Enlaces
+{
+public:
+    Enlaces ();
+
+    // Calcula los enlaces en [0, duracion] (0 = hasta el ultimo punto de
+    // paso) con ventanas de ventana segundos y hilos hilos (0 = uno por
+    // nucleo)
+    void Calcular (const Trayectorias &trayectorias, double alcance, double duracion,
+                   uint32_t hilos = 0, double ventana = 10.0);
+
+    bool Escribir (const std::string &archivo) const;
+
+    // Devuelve false si no se pudo abrir o no es valido
+    bool Leer (const std::string &archivo);
+
+    uint32_t GetNNodos () const;
+    double GetAlcance () const;
+    double GetDuracion () const;
+    const std::vector<Enlace> &Get () const;
+
+    // Pares resueltos exactamente en el ultimo Calcular (suma por ventana)
+    uint64_t GetCandidatos () const;
+
+    // Indica si a y b estan dentro del alcance en el instante t
+    bool Conectados (uint32_t a, uint32_t b, double t) const;
+
+private:
+    struct Cabecera
+    {
+        char magia[8];
+        uint32_t version;
+        uint32_t nodos;
+        double alcance;
+        double duracion;
+        uint64_t enlaces;
+    };
+
+    struct Caja
+    {
+        double x0, y0, x1, y1;
+    };
+
+    // Posicion y velocidad de un nodo tramo a tramo
+    class Cursor
+    {
+    public:
+        Cursor (Recorrido recorrido, double t);
+        // Instante del proximo punto de paso
+        double Proximo () const;
+        // Avanza hasta el tramo que contiene t
+        void Avanzar (double t);
+        void Estado (double t, double &x, double &y, double &vx, double &vy) const;
+
+    private:
+        Recorrido m_recorrido;
+        // Primer punto con tiempo mayor que el instante actual
+        uint64_t m_siguiente;
+    };
+
+    static Caja Recorre (Recorrido recorrido, const Trayectorias &trayectorias, uint32_t nodo,
+                         double t0, double t1);
+    static void Resolver (Recorrido ra, Recorrido rb, uint32_t a, uint32_t b, double t0, double t1,
+                          double alcance, std::vector<Enlace> &salida);
+    static void Agregar (std::vector<Enlace> &salida, uint32_t a, uint32_t b,
+                         double desde, double hasta);
+
+    uint32_t m_nodos;
+    double m_alcance;
+    double m_duracion;
+    uint64_t m_candidatos;
+    std::vector<Enlace> m_enlaces;
+};
+
+inline
+Enlaces::Enlaces ()
+  : m_nodos (0),
+    m_alcance (0.0),
+    m_duracion (0.0),
+    m_candidatos (0)
+{
+}
+
+inline
+Enlaces::Cursor::Cursor (Recorrido recorrido, double t)
+  : m_recorrido (recorrido)
+{
+    m_siguiente = std::upper_bound (recorrido.begin (), recorrido.end (), t,
+                                    [] (double v, const Punto &q) { return v < q.t; })
+        - recorrido.begin ();
+}
+
+inline double
+Enlaces::Cursor::Proximo () const
+{
+    return m_siguiente < m_recorrido.size () ? m_recorrido[m_siguiente].t
+                                             : std::numeric_limits<double>::infinity ();
+}
+
+inline void
+Enlaces::Cursor::Avanzar (double t)
+{
+    while (m_siguiente < m_recorrido.size () && m_recorrido[m_siguiente].t <= t)
+    {
+        ++m_siguiente;
+    }
+}
+
+inline void
+Enlaces::Cursor::Estado (double t, double &x, double &y, double &vx, double &vy) const
+{
+    // Antes del primer punto o despues del ultimo el nodo esta quieto
+    if (m_siguiente == 0 || m_siguiente == m_recorrido.size ())
+    {
+        const Punto &p = m_siguiente == 0 ? m_recorrido.front () : m_recorrido.back ();
+        x = p.x;
+        y = p.y;
+        vx = 0.0;
+        vy = 0.0;
+        return;
+    }
+    const Punto &a = m_recorrido[m_siguiente - 1];
+    const Punto &b = m_recorrido[m_siguiente];
+    double dt = b.t - a.t;
+    vx = (b.x - a.x) / dt;
+    vy = (b.y - a.y) / dt;
+    x = a.x + vx * (t - a.t);
+    y = a.y + vy * (t - a.t);
+}
+
+inline Enlaces::Caja
+Enlaces::Recorre (Recorrido recorrido, const Trayectorias &trayectorias, uint32_t nodo,
+                  double t0, double t1)
+{
+    Punto p0 = trayectorias.Posicion (nodo, t0);
+    Punto p1 = trayectorias.Posicion (nodo, t1);
+    Caja c = { std::min (p0.x, p1.x), std::min (p0.y, p1.y),
+               std::max (p0.x, p1.x), std::max (p0.y, p1.y) };
+    const Punto *i = std::upper_bound (recorrido.begin (), recorrido.end (), t0,
+                                       [] (double v, const Punto &q) { return v < q.t; });
+    for (; i != recorrido.end () && i->t < t1; ++i)
+    {
+        c.x0 = std::min (c.x0, i->x);
+        c.y0 = std::min (c.y0, i->y);
+        c.x1 = std::max (c.x1, i->x);
+        c.y1 = std::max (c.y1, i->y);
+    }
+    return c;
+}
+
+inline void
+Enlaces::Agregar (std::vector<Enlace> &salida, uint32_t a, uint32_t b, double desde, double hasta)
+{
+    if (hasta <= desde)
+    {
+        return;
+    }
+    if (!salida.empty () && salida.back ().a == a && salida.back ().b == b
+        && salida.back ().hasta >= desde)
+    {
+        salida.back ().hasta = std::max (salida.back ().hasta, hasta);
+        return;
+    }
+    Enlace e = { a, b, desde, hasta };
+    salida.push_back (e);
+}
+
+inline void
+Enlaces::Resolver (Recorrido ra, Recorrido rb, uint32_t a, uint32_t b, double t0, double t1,
+                   double alcance, std::vector<Enlace> &salida)
+{
+    Cursor ca (ra, t0);
+    Cursor cb (rb, t0);
+    double r2 = alcance * alcance;
+    double s = t0;
+    while (s < t1)
+    {
+        double e = std::min (t1, std::min (ca.Proximo (), cb.Proximo ()));
+        double xa, ya, vxa, vya, xb, yb, vxb, vyb;
+        ca.Estado (s, xa, ya, vxa, vya);
+        cb.Estado (s, xb, yb, vxb, vyb);
+
+        // |D + V tau|^2 <= r^2  <=>  A tau^2 + 2 B tau + C <= 0
+        double dx = xb - xa, dy = yb - ya;
+        double vx = vxb - vxa, vy = vyb - vya;
+        double A = vx * vx + vy * vy;
+        double B = dx * vx + dy * vy;
+        double C = dx * dx + dy * dy - r2;
+        if (A == 0.0)
+        {
+            if (C <= 0.0)
+            {
+                Agregar (salida, a, b, s, e);
+            }
+        }
+        else
+        {
+            double discriminante = B * B - A * C;
+            if (discriminante >= 0.0)
+            {
+                double raiz = std::sqrt (discriminante);
+                double desde = s + (-B - raiz) / A;
+                double hasta = s + (-B + raiz) / A;
+                Agregar (salida, a, b, std::max (s, desde), std::min (e, hasta));
+            }
+        }
+
+        s = e;
+        ca.Avanzar (s);
+        cb.Avanzar (s);
+    }
+}
+
+inline void
+Enlaces::Calcular (const Trayectorias &trayectorias, double alcance, double duracion,
+                   uint32_t hilos, double ventana)
+{
+    uint32_t n = trayectorias.GetNNodos ();
+    if (duracion <= 0.0)
+    {
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            if (trayectorias.Tiene (i))
+            {
+                duracion = std::max (duracion, trayectorias.Get (i).back ().t);
+            }
+        }
+    }
+    m_nodos = n;
+    m_alcance = alcance;
+    m_duracion = duracion;
+    m_candidatos = 0;
+    m_enlaces.clear ();
+    if (hilos == 0)
+    {
+        hilos = std::max (1u, std::thread::hardware_concurrency ());
+    }
+    hilos = std::max (1u, std::min (hilos, n));
+    uint32_t ventanas = std::max (1.0, std::ceil (duracion / ventana));
+
+    std::vector<std::vector<Enlace> > porHilo (hilos);
+    std::vector<uint64_t> candidatos (hilos, 0);
+    std::vector<Caja> cajas (n);
+    std::vector<uint32_t> celdaInicio;
+    std::vector<uint32_t> celdaNodos;
+    for (uint32_t w = 0; w < ventanas; ++w)
+    {
+        double t0 = w * ventana;
+        double t1 = std::min (duracion, t0 + ventana);
+
+        // Cajas de la ventana y su extension
+        double x0 = std::numeric_limits<double>::infinity (), y0 = x0;
+        double x1 = -x0, y1 = -x0;
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            if (!trayectorias.Tiene (i))
+            {
+                continue;
+            }
+            cajas[i] = Recorre (trayectorias.Get (i), trayectorias, i, t0, t1);
+            x0 = std::min (x0, cajas[i].x0);
+            y0 = std::min (y0, cajas[i].y0);
+            x1 = std::max (x1, cajas[i].x1);
+            y1 = std::max (y1, cajas[i].y1);
+        }
+        if (x0 > x1)
+        {
+            break;
+        }
+
+        // Cuadricula de celdas de lado alcance; cada nodo en las celdas que
+        // toca su caja (orden por conteo)
+        uint32_t columnas = std::min (4096.0, std::floor ((x1 - x0) / alcance) + 1);
+        uint32_t filas = std::min (4096.0, std::floor ((y1 - y0) / alcance) + 1);
+        double lado = std::max ((x1 - x0) / columnas, (y1 - y0) / filas) + 1e-9;
+        lado = std::max (lado, alcance);
+        // Celdas que toca una caja, recortadas a la cuadricula
+        auto celda = [lado] (double v, double origen, uint32_t limite) -> uint32_t
+        {
+            return std::min<double> (limite - 1, std::max (0.0, (v - origen) / lado));
+        };
+        auto celdas = [&] (const Caja &c, uint32_t &cx0, uint32_t &cy0, uint32_t &cx1, uint32_t &cy1)
+        {
+            cx0 = celda (c.x0, x0, columnas);
+            cy0 = celda (c.y0, y0, filas);
+            cx1 = celda (c.x1, x0, columnas);
+            cy1 = celda (c.y1, y0, filas);
+        };
+        celdaInicio.assign (uint64_t (columnas) * filas + 1, 0);
+        for (int pasada = 0; pasada < 2; ++pasada)
+        {
+            if (pasada == 1)
+            {
+                for (uint64_t k = 1; k < celdaInicio.size (); ++k)
+                {
+                    celdaInicio[k] += celdaInicio[k - 1];
+                }
+                celdaNodos.resize (celdaInicio.back ());
+            }
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                if (!trayectorias.Tiene (i))
+                {
+                    continue;
+                }
+                uint32_t cx0, cy0, cx1, cy1;
+                celdas (cajas[i], cx0, cy0, cx1, cy1);
+                for (uint32_t cy = cy0; cy <= cy1; ++cy)
+                {
+                    for (uint32_t cx = cx0; cx <= cx1; ++cx)
+                    {
+                        uint64_t k = uint64_t (cy) * columnas + cx;
+                        if (pasada == 0)
+                        {
+                            ++celdaInicio[k + 1];
+                        }
+                        else
+                        {
+                            celdaNodos[--celdaInicio[k + 1]] = i;
+                        }
+                    }
+                }
+            }
+        }
+        // La segunda pasada deja celdaInicio[k + 1] en el inicio de k
+        celdaInicio.erase (celdaInicio.begin ());
+        celdaInicio.push_back (celdaNodos.size ());
+
+        std::vector<std::thread> trabajadores;
+        for (uint32_t h = 0; h < hilos; ++h)
+        {
+            trabajadores.push_back (std::thread ([&, h] ()
+            {
+                std::vector<uint32_t> visto (n, std::numeric_limits<uint32_t>::max ());
+                for (uint32_t a = h; a < n; a += hilos)
+                {
+                    if (!trayectorias.Tiene (a))
+                    {
+                        continue;
+                    }
+                    Caja c = cajas[a];
+                    Caja ampliada = { c.x0 - alcance, c.y0 - alcance, c.x1 + alcance, c.y1 + alcance };
+                    uint32_t cx0, cy0, cx1, cy1;
+                    celdas (ampliada, cx0, cy0, cx1, cy1);
+                    for (uint32_t cy = cy0; cy <= cy1; ++cy)
+                    {
+                        for (uint32_t cx = cx0; cx <= cx1; ++cx)
+                        {
+                            uint64_t k = uint64_t (cy) * columnas + cx;
+                            for (uint32_t m = celdaInicio[k]; m < celdaInicio[k + 1]; ++m)
+                            {
+                                uint32_t b = celdaNodos[m];
+                                if (b <= a || visto[b] == a)
+                                {
+                                    continue;
+                                }
+                                visto[b] = a;
+                                // Distancia entre cajas
+                                const Caja &d = cajas[b];
+                                double sx = std::max (0.0, std::max (d.x0 - c.x1, c.x0 - d.x1));
+                                double sy = std::max (0.0, std::max (d.y0 - c.y1, c.y0 - d.y1));
+                                if (sx * sx + sy * sy > alcance * alcance)
+                                {
+                                    continue;
+                                }
+                                ++candidatos[h];
+                                Resolver (trayectorias.Get (a), trayectorias.Get (b), a, b,
+                                          t0, t1, alcance, porHilo[h]);
+                            }
+                        }
+                    }
+                }
+            }));
+        }
+        for (std::thread &t : trabajadores)
+        {
+            t.join ();
+        }
+    }
+
+    // Unir hilos y ventanas: los intervalos de un par que se tocan en el
+    // borde de una ventana son uno solo
+    std::vector<Enlace> todos;
+    for (uint32_t h = 0; h < hilos; ++h)
+    {
+        todos.insert (todos.end (), porHilo[h].begin (), porHilo[h].end ());
+        m_candidatos += candidatos[h];
+    }
+    std::sort (todos.begin (), todos.end (), [] (const Enlace &p, const Enlace &q)
+    {
+        return p.a != q.a ? p.a < q.a : p.b != q.b ? p.b < q.b : p.desde < q.desde;
+    });
+    for (const Enlace &e : todos)
+    {
+        Agregar (m_enlaces, e.a, e.b, e.desde, e.hasta);
+    }
+}
+
+inline bool
+Enlaces::Escribir (const std::string &archivo) const
+{
+    std::ofstream os (archivo.c_str (), std::ios::binary);
+    if (!os)
+    {
+        return false;
+    }
+    Cabecera cabecera;
+    std::memcpy (cabecera.magia, "TESISENL", 8);
+    cabecera.version = 1;
+    cabecera.nodos = m_nodos;
+    cabecera.alcance = m_alcance;
+    cabecera.duracion = m_duracion;
+    cabecera.enlaces = m_enlaces.size ();
+    os.write (reinterpret_cast<const char *> (&cabecera), sizeof (cabecera));
+    os.write (reinterpret_cast<const char *> (m_enlaces.data ()), m_enlaces.size () * sizeof (Enlace));
+    return bool (os);
+}
+
+inline bool
+Enlaces::Leer (const std::string &archivo)
+{
+    std::ifstream is (archivo.c_str (), std::ios::binary);
+    Cabecera cabecera;
+    if (!is || !is.read (reinterpret_cast<char *> (&cabecera), sizeof (cabecera))
+        || std::memcmp (cabecera.magia, "TESISENL", 8) != 0 || cabecera.version != 1)
+    {
+        return false;
+    }
+    m_enlaces.resize (cabecera.enlaces);
+    if (!is.read (reinterpret_cast<char *> (m_enlaces.data ()), cabecera.enlaces * sizeof (Enlace)))
+    {
+        m_enlaces.clear ();
+        return false;
+    }
+    m_nodos = cabecera.nodos;
+    m_alcance = cabecera.alcance;
+    m_duracion = cabecera.duracion;
+    m_candidatos = 0;
+    return true;
+}
+
+inline uint32_t
+Enlaces::GetNNodos () const
+{
+    return m_nodos;
+}
+
+inline double
+Enlaces::GetAlcance () const
+{
+    return m_alcance;
+}
+
+inline double
+Enlaces::GetDuracion () const
+{
+    return m_duracion;
+}
+
+inline const std::vector<Enlace> &
+Enlaces::Get () const
+{
+    return m_enlaces;
+}
+
+inline uint64_t
+Enlaces::GetCandidatos () const
+{
+    return m_candidatos;
+}
+
+inline bool
+Enlaces::Conectados (uint32_t a, uint32_t b, double t) const
+{
+    if (b < a)
+    {
+        std::swap (a, b);
+    }
+    // Ultimo intervalo del par que empieza en o antes de t
+    Enlace clave = { a, b, t, t };
+    std::vector<Enlace>::const_iterator i =
+        std::upper_bound (m_enlaces.begin (), m_enlaces.end (), clave, [] (const Enlace &p, const Enlace &q)
+    {
+        return p.a != q.a ? p.a < q.a : p.b != q.b ? p.b < q.b : p.desde < q.desde;
+    });
+    if (i == m_enlaces.begin ())
+    {
+        return false;
+    }
+    --i;
+    return i->a == a && i->b == b && t < i->hasta;
+}
+
+} // namespace tesis
+
+#endif /* TESIS_ENLACES_H */
@@ -0,0 +1,299 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TESIS_ESCENARIO_RWP_H
+#define TESIS_ESCENARIO_RWP_H
+
+#include "trayectorias.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tesis {
+
+// Parametros de un escenario RandomWaypoint de BonnMotion (.params)
+struct ParametrosRwp
+{
+    double x;
+    double y;
+    double duracion;
+    double ignorar;
+    uint32_t nodos;
+    double velocidadMinima;
+    double velocidadMaxima;
+    double pausaMaxima;
+    // 3: destino libre en el plano, 4: cada tramo cambia solo x o solo y
+    uint32_t dim;
+    uint64_t semilla;
+};
+
+// Lee un .params de BonnMotion; devuelve false si no se pudo abrir o el
+// modelo no es RandomWaypoint
+inline bool
+LeerParametrosRwp (const std::string &archivo, ParametrosRwp &p)
+{
+    std::ifstream is (archivo.c_str ());
+    if (!is)
+    {
+        return false;
+    }
+    p.x = 300.0;
+    p.y = 300.0;
+    p.duracion = 150.0;
+    p.ignorar = 3600.0;
+    p.nodos = 0;
+    p.velocidadMinima = 0.5;
+    p.velocidadMaxima = 1.5;
+    p.pausaMaxima = 60.0;
+    p.dim = 3;
+    p.semilla = 1;
+
+    bool rwp = false;
+    std::string linea;
+    while (std::getline (is, linea))
+    {
+        std::string::size_type igual = linea.find ('=');
+        if (igual == std::string::npos)
+        {
+            continue;
+        }
+        std::string clave = linea.substr (0, igual);
+        const char *valor = linea.c_str () + igual + 1;
+        if (clave == "model")
+        {
+            rwp = std::string (valor) == "RandomWaypoint";
+        }
+        else if (clave == "x")
+        {
+            p.x = std::strtod (valor, 0);
+        }
+        else if (clave == "y")
+        {
+            p.y = std::strtod (valor, 0);
+        }
+        else if (clave == "duration")
+        {
+            p.duracion = std::strtod (valor, 0);
+        }
+        else if (clave == "ignore")
+        {
+            p.ignorar = std::strtod (valor, 0);
+        }
+        else if (clave == "nn")
+        {
+            p.nodos = std::strtoul (valor, 0, 10);
+        }
+        else if (clave == "minspeed")
+        {
+            p.velocidadMinima = std::strtod (valor, 0);
+        }
+        else if (clave == "maxspeed")
+        {
+            p.velocidadMaxima = std::strtod (valor, 0);
+        }
+        else if (clave == "maxpause")
+        {
+            p.pausaMaxima = std::strtod (valor, 0);
+        }
+        else if (clave == "dim")
+        {
+            p.dim = std::strtoul (valor, 0, 10);
+        }
+        else if (clave == "randomSeed")
+        {
+            p.semilla = std::strtoull (valor, 0, 10);
+        }
+    }
+    return rwp;
+}
+
+/*
+ * Generador RandomWaypoint con la misma definicion que BonnMotion: posicion
+ * inicial uniforme en el rectangulo, destino uniforme (con dim=4 el tramo
+ * solo cambia una coordenada, elegida al azar), velocidad uniforme entre la
+ * minima y la maxima, pausa uniforme hasta pausaMaxima al llegar, y se
+ * descartan los primeros "ignorar" segundos para partir del regimen
+ * estacionario.
+ *
+ * Cada nodo tiene su propio generador, sembrado con (semilla, nodo), asi
+ * que el resultado no depende del numero de hilos y los nodos se generan en
+ * paralelo por bloques. No reproduce los numeros del Random de Java: la
+ * misma semilla da un escenario distinto al del archivo de BonnMotion, con
+ * la misma distribucion.
+ */
+class GeneradorRwp
+{
+public:
+    explicit GeneradorRwp (const ParametrosRwp &parametros);
+
+    // Genera todos los nodos en hilos hilos (0 = uno por nucleo)
+    void Generar (Trayectorias &trayectorias, uint32_t hilos = 0) const;
+
+private:
+    // SplitMix64: estado de 8 bytes, sembrar un nodo no cuesta nada
+    class Aleatorio
+    {
+    public:
+        explicit Aleatorio (uint64_t semilla) : m_estado (semilla) {}
+        // Uniforme en [0, 1)
+        double operator() ();
+
+    private:
+        uint64_t m_estado;
+    };
+
+    void GenerarNodo (uint32_t nodo, std::vector<Punto> &puntos) const;
+    static void Agregar (std::vector<Punto> &puntos, double t, double x, double y);
+
+    ParametrosRwp m_p;
+};
+
+inline
+GeneradorRwp::GeneradorRwp (const ParametrosRwp &parametros)
+  : m_p (parametros)
+{
+}
+
+inline double
+GeneradorRwp::Aleatorio::operator() ()
+{
+    uint64_t z = (m_estado += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return (z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+inline void
+GeneradorRwp::Agregar (std::vector<Punto> &puntos, double t, double x, double y)
+{
+    Punto p = { t, x, y };
+    puntos.push_back (p);
+}
+
+inline void
+GeneradorRwp::GenerarNodo (uint32_t nodo, std::vector<Punto> &puntos) const
+{
+    // Flujo del nodo: la semilla mezclada con el indice
+    Aleatorio mezcla (m_p.semilla ^ (uint64_t (nodo) << 32 | nodo));
+    Aleatorio u (uint64_t (mezcla () * 9007199254740992.0) ^ nodo);
+
+    // Recorrido completo desde -ignorar; se recorta al final
+    double fin = m_p.duracion;
+    double t = -m_p.ignorar;
+    double x = u () * m_p.x;
+    double y = u () * m_p.y;
+    std::vector<Punto> completo;
+    Agregar (completo, t, x, y);
+    while (t < fin)
+    {
+        double dx = x, dy = y;
+        if (m_p.dim == 4)
+        {
+            if (u () < 0.5)
+            {
+                dx = u () * m_p.x;
+            }
+            else
+            {
+                dy = u () * m_p.y;
+            }
+        }
+        else
+        {
+            dx = u () * m_p.x;
+            dy = u () * m_p.y;
+        }
+        double velocidad = m_p.velocidadMinima + u () * (m_p.velocidadMaxima - m_p.velocidadMinima);
+        double distancia = std::sqrt ((dx - x) * (dx - x) + (dy - y) * (dy - y));
+        t += distancia / velocidad;
+        x = dx;
+        y = dy;
+        Agregar (completo, t, x, y);
+
+        double pausa = u () * m_p.pausaMaxima;
+        if (pausa > 0)
+        {
+            t += pausa;
+            Agregar (completo, t, x, y);
+        }
+    }
+
+    // Recorte a [0, duracion] interpolando en los extremos
+    puntos.clear ();
+    for (uint64_t i = 1; i < completo.size (); ++i)
+    {
+        const Punto &a = completo[i - 1];
+        const Punto &b = completo[i];
+        if (b.t <= 0)
+        {
+            continue;
+        }
+        if (puntos.empty ())
+        {
+            double f = b.t > a.t ? (0 - a.t) / (b.t - a.t) : 1.0;
+            Agregar (puntos, 0.0, a.x + f * (b.x - a.x), a.y + f * (b.y - a.y));
+        }
+        if (b.t >= fin)
+        {
+            double f = (fin - a.t) / (b.t - a.t);
+            if (fin > puntos.back ().t)
+            {
+                Agregar (puntos, fin, a.x + f * (b.x - a.x), a.y + f * (b.y - a.y));
+            }
+            break;
+        }
+        if (b.t > puntos.back ().t)
+        {
+            Agregar (puntos, b.t, b.x, b.y);
+        }
+    }
+}
+
+inline void
+GeneradorRwp::Generar (Trayectorias &trayectorias, uint32_t hilos) const
+{
+    if (hilos == 0)
+    {
+        hilos = std::max (1u, std::thread::hardware_concurrency ());
+    }
+    hilos = std::max (1u, std::min (hilos, m_p.nodos));
+
+    std::vector<std::vector<Punto> > porNodo (m_p.nodos);
+    std::vector<std::thread> trabajadores;
+    for (uint32_t h = 0; h < hilos; ++h)
+    {
+        trabajadores.push_back (std::thread ([this, h, hilos, &porNodo] ()
+        {
+            for (uint32_t n = uint64_t (h) * m_p.nodos / hilos; n < uint64_t (h + 1) * m_p.nodos / hilos; ++n)
+            {
+                GenerarNodo (n, porNodo[n]);
+            }
+        }));
+    }
+    for (std::thread &t : trabajadores)
+    {
+        t.join ();
+    }
+
+    std::vector<uint64_t> indices (1, 0);
+    for (const std::vector<Punto> &puntos : porNodo)
+    {
+        indices.push_back (indices.back () + puntos.size ());
+    }
+    std::vector<Punto> todos (indices.back ());
+    for (uint32_t n = 0; n < m_p.nodos; ++n)
+    {
+        std::copy (porNodo[n].begin (), porNodo[n].end (), todos.begin () + indices[n]);
+    }
+    trayectorias.Asignar (indices, todos);
+}
+
+} // namespace tesis
+
+#endif /* TESIS_ESCENARIO_RWP_H */
@@ -0,0 +1,231 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TESIS_FUENTE_MOVILIDAD_H
+#define TESIS_FUENTE_MOVILIDAD_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+
+#include "escenario-rwp.h"
+#include "instalar-trayectorias.h"
+#include "trayectorias.h"
+
+#include <sstream>
+#include <string>
+
+namespace tesis {
+
+/*
+ * Origen de la movilidad de los nodos, elegido por configuracion:
+ *
+ *   traza       trayectorias de un archivo ns-2 o compilado, o generadas
+ *               en el proceso a partir de un .params de BonnMotion
+ *   aleatoria   Random Waypoint en un rectangulo
+ *   cuadricula  nodos fijos en fila a Paso metros (como en "scripts pruebas")
+ *
+ * Instalar () construye un solo modelo por nodo. Con traza, los nodos que
+ * no aparecen en el archivo reciben el modelo aleatorio.
+ */
+class FuenteMovilidad
+{
+public:
+    enum Tipo
+    {
+        TRAZA,
+        ALEATORIA,
+        CUADRICULA
+    };
+
+    FuenteMovilidad ();
+
+    // Acepta "traza", "aleatoria", "cuadricula" (o trace, random, grid)
+    bool SetTipo (const std::string &tipo);
+    Tipo GetTipo () const;
+
+    void SetTraza (const std::string &archivo);
+    void SetPaso (double paso);
+    void SetAleatoria (double ancho, double alto, double velocidadMaxima, double pausa);
+
+    // Lee la traza una sola vez (solo con TRAZA); false si no se pudo
+    bool Preparar ();
+
+    const Trayectorias &GetTrayectorias () const;
+
+    void Instalar (ns3::NodeContainer nodos) const;
+
+private:
+    void InstalarAleatoria (ns3::NodeContainer nodos) const;
+    void InstalarCuadricula (ns3::NodeContainer nodos) const;
+
+    Tipo m_tipo;
+    std::string m_traza;
+    Trayectorias m_trayectorias;
+    double m_paso;
+    double m_ancho;
+    double m_alto;
+    double m_velocidadMaxima;
+    double m_pausa;
+};
+
+inline
+FuenteMovilidad::FuenteMovilidad ()
+  : m_tipo (TRAZA),
+    m_paso (40.0),
+    m_ancho (150.0),
+    m_alto (150.0),
+    m_velocidadMaxima (20.0),
+    m_pausa (0.0)
+{
+}
+
+inline bool
+FuenteMovilidad::SetTipo (const std::string &tipo)
+{
+    if (tipo == "traza" || tipo == "trace")
+    {
+        m_tipo = TRAZA;
+    }
+    else if (tipo == "aleatoria" || tipo == "random")
+    {
+        m_tipo = ALEATORIA;
+    }
+    else if (tipo == "cuadricula" || tipo == "grid")
+    {
+        m_tipo = CUADRICULA;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+inline FuenteMovilidad::Tipo
+FuenteMovilidad::GetTipo () const
+{
+    return m_tipo;
+}
+
+inline void
+FuenteMovilidad::SetTraza (const std::string &archivo)
+{
+    m_traza = archivo;
+}
+
+inline void
+FuenteMovilidad::SetPaso (double paso)
+{
+    m_paso = paso;
+}
+
+inline void
+FuenteMovilidad::SetAleatoria (double ancho, double alto, double velocidadMaxima, double pausa)
+{
+    m_ancho = ancho;
+    m_alto = alto;
+    m_velocidadMaxima = velocidadMaxima;
+    m_pausa = pausa;
+}
+
+inline bool
+FuenteMovilidad::Preparar ()
+{
+    if (m_tipo != TRAZA)
+    {
+        return true;
+    }
+    std::string::size_type punto = m_traza.rfind ('.');
+    if (punto != std::string::npos && m_traza.substr (punto) == ".params")
+    {
+        ParametrosRwp parametros;
+        if (!LeerParametrosRwp (m_traza, parametros))
+        {
+            return false;
+        }
+        GeneradorRwp (parametros).Generar (m_trayectorias);
+        return true;
+    }
+    return m_trayectorias.Leer (m_traza);
+}
+
+inline const Trayectorias &
+FuenteMovilidad::GetTrayectorias () const
+{
+    return m_trayectorias;
+}
+
+inline void
+FuenteMovilidad::Instalar (ns3::NodeContainer nodos) const
+{
+    switch (m_tipo)
+    {
+    case TRAZA:
+        {
+            ns3::NodeContainer sinTraza;
+            for (ns3::NodeContainer::Iterator i = nodos.Begin (); i != nodos.End (); ++i)
+            {
+                if (!m_trayectorias.Tiene ((*i)->GetId ()))
+                {
+                    sinTraza.Add (*i);
+                }
+            }
+            InstalarAleatoria (sinTraza);
+            InstalarTrayectorias (m_trayectorias, nodos);
+        }
+        break;
+    case ALEATORIA:
+        InstalarAleatoria (nodos);
+        break;
+    case CUADRICULA:
+        InstalarCuadricula (nodos);
+        break;
+    }
+}
+
+inline void
+FuenteMovilidad::InstalarAleatoria (ns3::NodeContainer nodos) const
+{
+    if (nodos.GetN () == 0)
+    {
+        return;
+    }
+
+    std::ostringstream x, y, velocidad, pausa;
+    x << "ns3::UniformRandomVariable[Min=0.0|Max=" << m_ancho << "]";
+    y << "ns3::UniformRandomVariable[Min=0.0|Max=" << m_alto << "]";
+    velocidad << "ns3::UniformRandomVariable[Min=0.0|Max=" << m_velocidadMaxima << "]";
+    pausa << "ns3::ConstantRandomVariable[Constant=" << m_pausa << "]";
+
+    ns3::ObjectFactory of;
+    of.SetTypeId ("ns3::RandomRectanglePositionAllocator");
+    of.Set ("X", ns3::StringValue (x.str ()));
+    of.Set ("Y", ns3::StringValue (y.str ()));
+    ns3::Ptr<ns3::PositionAllocator> pa = of.Create ()->GetObject<ns3::PositionAllocator> ();
+
+    ns3::MobilityHelper mobility;
+    mobility.SetMobilityModel ("ns3::RandomWaypointMobilityModel",
+                               "Speed", ns3::StringValue (velocidad.str ()),
+                               "Pause", ns3::StringValue (pausa.str ()),
+                               "PositionAllocator", ns3::PointerValue (pa));
+    mobility.Install (nodos);
+}
+
+inline void
+FuenteMovilidad::InstalarCuadricula (ns3::NodeContainer nodos) const
+{
+    ns3::MobilityHelper mobility;
+    mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                   "MinX", ns3::DoubleValue (0.0),
+                                   "MinY", ns3::DoubleValue (0.0),
+                                   "DeltaX", ns3::DoubleValue (m_paso),
+                                   "DeltaY", ns3::DoubleValue (0),
+                                   "GridWidth", ns3::UintegerValue (nodos.GetN ()),
+                                   "LayoutType", ns3::StringValue ("RowFirst"));
+    mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+    mobility.Install (nodos);
+}
+
+} // namespace tesis
+
+#endif /* TESIS_FUENTE_MOVILIDAD_H */
@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TESIS_HELLO_ADAPTATIVO_H
+#define TESIS_HELLO_ADAPTATIVO_H
+
+#include <algorithm>
+#include <cstdint>
+
+namespace tesis {
+
+// Parametros del HELLO adaptativo; en el port son atributos de
+// aodv::RoutingProtocol6 que se pasan con Aodv6Helper::Set
+struct ParametrosHello
+{
+    // HelloInterval: el intervalo tras un cambio de vecinos, s
+    double minimo;
+    // MaxHelloInterval: tope del intervalo con vecinos estables, s
+    double maximo;
+    // HelloBackoff: factor del intervalo tras cada HELLO sin cambios
+    double factor;
+    // AllowedHelloLoss
+    uint32_t perdidas;
+    // HelloSuppression: no mandar el HELLO si una difusion (RREQ, RERR)
+    // ya anuncio al nodo en el intervalo
+    bool suprimir;
+
+    // Lo que hace aodv::RoutingProtocol de ns-3: 1 s fijo, 2 perdidas, sin
+    // HELLO si hubo una difusion
+    static ParametrosHello Fijo ();
+};
+
+inline ParametrosHello
+ParametrosHello::Fijo ()
+{
+    ParametrosHello p = { 1.0, 1.0, 1.0, 2, true };
+    return p;
+}
+
+/*
+ * Politica de HELLO adaptativo de un nodo.
+ *
+ * Cada HELLO que sale sin que los vecinos hayan cambiado desde el anterior
+ * multiplica el intervalo por factor, hasta maximo. Un vecino nuevo solo
+ * frena ese crecimiento (ya escucha al nodo en el proximo anuncio); uno
+ * perdido indica movimiento, devuelve el intervalo a minimo y adelanta el
+ * proximo HELLO a minimo despues del ultimo anuncio. Un HELLO se suprime
+ * si una difusion propia ya anuncio al nodo dentro del intervalo (como
+ * m_lastBcastTime en ns-3).
+ *
+ * Con intervalos variables el receptor no puede suponer HelloInterval: el
+ * HELLO y las difusiones llevan en el campo de vida (RFC 3561, 6.9)
+ * GetVida = perdidas x el intervalo hasta el proximo anuncio, y el receptor
+ * vence al vecino con esa vida en lugar de AllowedHelloLoss x HelloInterval.
+ *
+ * El port mantiene el temporizador: lo programa en GetProximo, llama a
+ * Vencer cuando vence y lo reprograma si GetProximo se adelanto despues de
+ * VecinoPerdido. Los tiempos son segundos de simulacion.
+ */
+class HelloAdaptativo
+{
+public:
+    explicit HelloAdaptativo (const ParametrosHello &parametros = ParametrosHello::Fijo ());
+
+    // Primer HELLO desfase segundos despues de ahora
+    void Iniciar (double ahora, double desfase);
+
+    // Instante del proximo HELLO
+    double GetProximo () const { return m_proximo; }
+
+    // Intervalo actual
+    double GetIntervalo () const { return m_intervalo; }
+
+    // Vida del anuncio que sale ahora
+    double GetVida () const { return m_parametros.perdidas * m_intervalo; }
+
+    // Al llegar GetProximo: true si hay que mandar el HELLO, false si se
+    // suprime; deja el siguiente en GetProximo
+    bool Vencer (double ahora);
+
+    // El nodo mando una difusion que anuncia GetVida
+    void Difusion (double ahora);
+
+    // Aparecio un vecino: el intervalo no crece en el proximo HELLO
+    void VecinoNuevo ();
+
+    // Se perdio un vecino (vencio o fallo un envio): vuelve a minimo
+    void VecinoPerdido (double ahora);
+
+    uint64_t GetEnviados () const { return m_enviados; }
+    uint64_t GetSuprimidos () const { return m_suprimidos; }
+
+private:
+    ParametrosHello m_parametros;
+    double m_intervalo;
+    // Ultimo anuncio (HELLO o difusion); negativo si no hubo
+    double m_ultimo;
+    double m_proximo;
+    bool m_cambio;
+    uint64_t m_enviados;
+    uint64_t m_suprimidos;
+};
+
+inline
+HelloAdaptativo::HelloAdaptativo (const ParametrosHello &parametros)
+  : m_parametros (parametros),
+    m_intervalo (parametros.minimo),
+    m_ultimo (-1.0),
+    m_proximo (0.0),
+    m_cambio (false),
+    m_enviados (0),
+    m_suprimidos (0)
+{
+}
+
+inline void
+HelloAdaptativo::Iniciar (double ahora, double desfase)
+{
+    m_proximo = ahora + desfase;
+}
+
+inline bool
+HelloAdaptativo::Vencer (double ahora)
+{
+    // La misma suma para comparar y reprogramar: con ahora - m_ultimo el
+    // redondeo podia dejar el proximo en ahora y suprimirlo sin fin
+    double siguiente = m_ultimo + m_intervalo;
+    if (m_parametros.suprimir && m_ultimo >= 0 && ahora < siguiente)
+    {
+        m_proximo = siguiente;
+        ++m_suprimidos;
+        return false;
+    }
+    if (!m_cambio)
+    {
+        m_intervalo = std::min (m_parametros.maximo, m_intervalo * m_parametros.factor);
+    }
+    m_cambio = false;
+    m_ultimo = ahora;
+    m_proximo = ahora + m_intervalo;
+    ++m_enviados;
+    return true;
+}
+
+inline void
+HelloAdaptativo::Difusion (double ahora)
+{
+    m_ultimo = ahora;
+}
+
+inline void
+HelloAdaptativo::VecinoNuevo ()
+{
+    m_cambio = true;
+}
+
+inline void
+HelloAdaptativo::VecinoPerdido (double ahora)
+{
+    m_cambio = true;
+    if (m_intervalo > m_parametros.minimo)
+    {
+        m_intervalo = m_parametros.minimo;
+        m_proximo = std::min (m_proximo, std::max (ahora, m_ultimo + m_intervalo));
+    }
+}
+
+} // namespace tesis
+
+#endif /* TESIS_HELLO_ADAPTATIVO_H */
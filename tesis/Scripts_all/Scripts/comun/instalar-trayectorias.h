@@ -0,0 +1,34 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TESIS_INSTALAR_TRAYECTORIAS_H
+#define TESIS_INSTALAR_TRAYECTORIAS_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+
+#include "movilidad-trayectoria.h"
+#include "trayectorias.h"
+
+namespace tesis {
+
+// Instala un MovilidadTrayectoria en cada nodo con trayectoria
+inline void
+InstalarTrayectorias (const Trayectorias &trayectorias, ns3::NodeContainer nodos)
+{
+    for (ns3::NodeContainer::Iterator i = nodos.Begin (); i != nodos.End (); ++i)
+    {
+        uint32_t id = (*i)->GetId ();
+        if (!trayectorias.Tiene (id))
+        {
+            continue;
+        }
+        ns3::Ptr<MovilidadTrayectoria> modelo = ns3::CreateObject<MovilidadTrayectoria> ();
+        modelo->SetRecorrido (trayectorias.Get (id));
+        (*i)->AggregateObject (modelo);
+    }
+}
+
+} // namespace tesis
+
+#endif /* TESIS_INSTALAR_TRAYECTORIAS_H */
@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TESIS_INTERNADOR6_H
+#define TESIS_INTERNADOR6_H
+
+#include "tabla-rutas6.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace tesis {
+
+/*
+ * Tabla de direcciones IPv6 internadas: cada direccion distinta recibe un
+ * identificador denso de 32 bits la primera vez que se ve, y el estado AODV
+ * de cada nodo (destino, siguiente salto e interfaz de las rutas,
+ * precursores, cache de RREQ, cola de pedidos) guarda identificadores en
+ * lugar de los 16 bytes. Comparar dos direcciones pasa a ser comparar dos
+ * enteros, y los identificadores sirven de clave en TablaRutas6<..., uint32_t>.
+ *
+ * Hay una por simulacion (Global); los identificadores no se reutilizan
+ * mientras viva, asi que se vacia con clear () solo despues de
+ * Simulator::Destroy (), cuando ningun nodo guarda identificadores.
+ */
+class Internador6
+{
+public:
+    static const uint32_t NINGUNA = 0xffffffff;
+
+    // La tabla de la simulacion en curso
+    static Internador6 &Global ();
+
+    // Identificador de la direccion; la agrega si no estaba
+    uint32_t Internar (const Direccion6 &direccion);
+
+    template <typename Direccion>
+    uint32_t Internar (const Direccion &direccion) { return Internar (Direccion6::De (direccion)); }
+
+    // Identificador de la direccion o NINGUNA, sin agregarla
+    uint32_t Buscar (const Direccion6 &direccion) const;
+
+    // Direccion del identificador
+    const Direccion6 &GetDireccion (uint32_t id) const;
+
+    uint32_t size () const { return m_direcciones.size (); }
+
+    // Bytes reservados por la tabla
+    uint64_t GetMemoria () const;
+
+    void clear ();
+
+private:
+    TablaRutas6<uint32_t> m_ids;
+    std::vector<Direccion6> m_direcciones;
+};
+
+inline Internador6 &
+Internador6::Global ()
+{
+    static Internador6 global;
+    return global;
+}
+
+inline uint32_t
+Internador6::Internar (const Direccion6 &direccion)
+{
+    const uint32_t *id = m_ids.Buscar (direccion);
+    if (id != 0)
+    {
+        return *id;
+    }
+    uint32_t nuevo = m_direcciones.size ();
+    m_ids.Agregar (direccion, nuevo);
+    m_direcciones.push_back (direccion);
+    return nuevo;
+}
+
+inline uint32_t
+Internador6::Buscar (const Direccion6 &direccion) const
+{
+    const uint32_t *id = m_ids.Buscar (direccion);
+    return id != 0 ? *id : NINGUNA;
+}
+
+inline const Direccion6 &
+Internador6::GetDireccion (uint32_t id) const
+{
+    return m_direcciones[id];
+}
+
+inline uint64_t
+Internador6::GetMemoria () const
+{
+    return m_ids.GetMemoria () + m_direcciones.capacity () * sizeof (Direccion6);
+}
+
+inline void
+Internador6::clear ()
+{
+    m_ids.clear ();
+    m_direcciones.clear ();
+}
+
+} // namespace tesis
+
+#endif /* TESIS_INTERNADOR6_H */
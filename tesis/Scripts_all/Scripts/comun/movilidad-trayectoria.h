@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TESIS_MOVILIDAD_TRAYECTORIA_H
+#define TESIS_MOVILIDAD_TRAYECTORIA_H
+
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+
+#include "trayectorias.h"
+
+#include <algorithm>
+
+namespace tesis {
+
+/*
+ * Modelo de movilidad que evalua la trayectoria lineal por tramos de un
+ * nodo en el momento de la consulta.
+ *
+ * GetPosition () ubica el tramo que contiene Simulator::Now () (el ultimo
+ * consultado o, si no, por busqueda binaria) e interpola, asi que el modelo
+ * no programa eventos. Solo con NotificarRumbo=true programa un evento por
+ * cada punto de paso para disparar el CourseChange de MobilityModel; hace
+ * falta si alguien lo escucha (el canal en cuadricula). Se fija con
+ * Config::SetDefault antes de instalar los modelos.
+ *
+ * Los puntos no se copian: el Recorrido apunta a un Trayectorias que debe
+ * vivir mientras dure la simulacion.
+ */
+class MovilidadTrayectoria : public ns3::MobilityModel
+{
+public:
+    static ns3::TypeId GetTypeId ();
+
+    MovilidadTrayectoria ();
+
+    void SetRecorrido (Recorrido recorrido);
+
+private:
+    virtual ns3::Vector DoGetPosition () const;
+    virtual void DoSetPosition (const ns3::Vector &position);
+    virtual ns3::Vector DoGetVelocity () const;
+
+    // Indice del primer punto con t mayor que el instante dado
+    uint64_t Siguiente (double t) const;
+    void ProgramarCambio ();
+    void Cambio ();
+
+    Recorrido m_recorrido;
+    mutable uint64_t m_siguiente;
+    bool m_fijo;
+    ns3::Vector m_posicionFija;
+    bool m_notificar;
+    bool m_notificando;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (MovilidadTrayectoria);
+
+inline ns3::TypeId
+MovilidadTrayectoria::GetTypeId ()
+{
+    static ns3::TypeId tid = ns3::TypeId ("tesis::MovilidadTrayectoria")
+        .SetParent<ns3::MobilityModel> ()
+        .AddConstructor<MovilidadTrayectoria> ()
+        .AddAttribute ("NotificarRumbo",
+                       "Disparar CourseChange en cada punto de paso.",
+                       ns3::BooleanValue (false),
+                       ns3::MakeBooleanAccessor (&MovilidadTrayectoria::m_notificar),
+                       ns3::MakeBooleanChecker ());
+    return tid;
+}
+
+inline
+MovilidadTrayectoria::MovilidadTrayectoria ()
+  : m_recorrido (0, 0),
+    m_siguiente (0),
+    m_fijo (false),
+    m_notificar (false),
+    m_notificando (false)
+{
+}
+
+inline void
+MovilidadTrayectoria::SetRecorrido (Recorrido recorrido)
+{
+    m_recorrido = recorrido;
+    m_siguiente = 0;
+    if (m_notificar)
+    {
+        ProgramarCambio ();
+    }
+}
+
+inline uint64_t
+MovilidadTrayectoria::Siguiente (double t) const
+{
+    // Las consultas casi siempre caen en el mismo tramo o en el siguiente
+    uint64_t n = m_recorrido.size ();
+    uint64_t i = m_siguiente;
+    if ((i == 0 || m_recorrido[i - 1].t <= t) && (i == n || t < m_recorrido[i].t))
+    {
+        return i;
+    }
+    if (i < n && m_recorrido[i].t <= t && (i + 1 == n || t < m_recorrido[i + 1].t))
+    {
+        return m_siguiente = i + 1;
+    }
+    const Punto *b = std::upper_bound (m_recorrido.begin (), m_recorrido.end (), t,
+                                       [] (double v, const Punto &q) { return v < q.t; });
+    return m_siguiente = b - m_recorrido.begin ();
+}
+
+inline ns3::Vector
+MovilidadTrayectoria::DoGetPosition () const
+{
+    if (m_fijo)
+    {
+        return m_posicionFija;
+    }
+    double t = ns3::Simulator::Now ().GetSeconds ();
+    uint64_t i = Siguiente (t);
+    if (i == 0)
+    {
+        return ns3::Vector (m_recorrido.front ().x, m_recorrido.front ().y, 0.0);
+    }
+    if (i == m_recorrido.size ())
+    {
+        return ns3::Vector (m_recorrido.back ().x, m_recorrido.back ().y, 0.0);
+    }
+    const Punto &a = m_recorrido[i - 1];
+    const Punto &b = m_recorrido[i];
+    double f = (t - a.t) / (b.t - a.t);
+    return ns3::Vector (a.x + f * (b.x - a.x), a.y + f * (b.y - a.y), 0.0);
+}
+
+inline void
+MovilidadTrayectoria::DoSetPosition (const ns3::Vector &position)
+{
+    // Fijar la posicion abandona la trayectoria
+    m_fijo = true;
+    m_posicionFija = position;
+    NotifyCourseChange ();
+}
+
+inline ns3::Vector
+MovilidadTrayectoria::DoGetVelocity () const
+{
+    uint64_t i = Siguiente (ns3::Simulator::Now ().GetSeconds ());
+    if (m_fijo || i == 0 || i == m_recorrido.size ())
+    {
+        return ns3::Vector (0.0, 0.0, 0.0);
+    }
+    const Punto &a = m_recorrido[i - 1];
+    const Punto &b = m_recorrido[i];
+    double dt = b.t - a.t;
+    return ns3::Vector ((b.x - a.x) / dt, (b.y - a.y) / dt, 0.0);
+}
+
+inline void
+MovilidadTrayectoria::ProgramarCambio ()
+{
+    if (m_notificando || m_fijo)
+    {
+        return;
+    }
+    uint64_t i = Siguiente (ns3::Simulator::Now ().GetSeconds ());
+    if (i == m_recorrido.size ())
+    {
+        return;
+    }
+    m_notificando = true;
+    ns3::Simulator::Schedule (ns3::Seconds (m_recorrido[i].t) - ns3::Simulator::Now (),
+                              &MovilidadTrayectoria::Cambio, this);
+}
+
+inline void
+MovilidadTrayectoria::Cambio ()
+{
+    m_notificando = false;
+    if (m_fijo)
+    {
+        return;
+    }
+    NotifyCourseChange ();
+    ProgramarCambio ();
+}
+
+} // namespace tesis
+
+#endif /* TESIS_MOVILIDAD_TRAYECTORIA_H */
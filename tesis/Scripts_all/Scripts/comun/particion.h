@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TESIS_PARTICION_H
+#define TESIS_PARTICION_H
+
+#include "enlaces.h"
+#include "trayectorias.h"
+
+#include <algorithm>
+#include <ostream>
+#include <vector>
+
+namespace tesis {
+
+/*
+ * Plan de reparto espacial de un escenario entre procesos para una
+ * simulacion distribuida con sincronizacion conservadora.
+ *
+ * Los nodos se asignan a franjas verticales con el mismo numero de nodos
+ * segun su posicion inicial, y se quedan en su proceso toda la corrida. Con
+ * la linea de tiempo de enlaces (tesis::Enlaces) el plan mide lo que decide
+ * si el reparto vale la pena: cuanto del tiempo de enlace entre pares
+ * dentro del alcance es entre procesos distintos (cada transmision por esos
+ * enlaces es un mensaje entre procesos) y el lookahead: retardo de
+ * propagacion a la distancia minima entre procesos mas la trama mas corta
+ * (preambulo y cabecera PLCP de 802.11b, 192 us). La linea de tiempo solo
+ * acota esa distancia: es al menos el alcance si ningun enlace cruza
+ * procesos, y si no se toma 0.
+ */
+class PlanParticion
+{
+public:
+    PlanParticion (const Trayectorias &trayectorias, const Enlaces &enlaces, uint32_t particiones);
+
+    // Proceso al que se asigna el nodo
+    uint32_t Proceso (uint32_t nodo) const;
+
+    // Lookahead conservador entre procesos (s)
+    double Lookahead () const;
+
+    void Reporte (std::ostream &os) const;
+
+private:
+    std::vector<uint32_t> m_proceso;
+    std::vector<uint32_t> m_nodosPorProceso;
+    uint64_t m_enlaces;
+    uint64_t m_enlacesCruzados;
+    double m_tiempo;
+    double m_tiempoCruzado;
+    double m_alcance;
+    double m_distanciaMinima;
+};
+
+inline
+PlanParticion::PlanParticion (const Trayectorias &trayectorias, const Enlaces &enlaces,
+                              uint32_t particiones)
+  : m_proceso (trayectorias.GetNNodos (), 0),
+    m_nodosPorProceso (particiones, 0),
+    m_enlaces (0),
+    m_enlacesCruzados (0),
+    m_tiempo (0.0),
+    m_tiempoCruzado (0.0),
+    m_alcance (enlaces.GetAlcance ()),
+    m_distanciaMinima (enlaces.GetAlcance ())
+{
+    // Franjas por cuantiles de x en t = 0
+    std::vector<uint32_t> orden;
+    for (uint32_t n = 0; n < trayectorias.GetNNodos (); ++n)
+    {
+        if (trayectorias.Tiene (n))
+        {
+            orden.push_back (n);
+        }
+    }
+    std::sort (orden.begin (), orden.end (),
+               [&trayectorias] (uint32_t a, uint32_t b)
+               {
+                   return trayectorias.Get (a).front ().x < trayectorias.Get (b).front ().x;
+               });
+    for (uint32_t i = 0; i < orden.size (); ++i)
+    {
+        uint32_t p = uint64_t (i) * particiones / orden.size ();
+        m_proceso[orden[i]] = p;
+        ++m_nodosPorProceso[p];
+    }
+
+    for (const Enlace &e : enlaces.Get ())
+    {
+        if (e.a >= m_proceso.size () || e.b >= m_proceso.size ())
+        {
+            continue;
+        }
+        double duracion = e.hasta - e.desde;
+        ++m_enlaces;
+        m_tiempo += duracion;
+        if (m_proceso[e.a] != m_proceso[e.b])
+        {
+            ++m_enlacesCruzados;
+            m_tiempoCruzado += duracion;
+            m_distanciaMinima = 0.0;
+        }
+    }
+}
+
+inline uint32_t
+PlanParticion::Proceso (uint32_t nodo) const
+{
+    return m_proceso[nodo];
+}
+
+inline double
+PlanParticion::Lookahead () const
+{
+    return m_distanciaMinima / 299792458.0 + 192e-6;
+}
+
+inline void
+PlanParticion::Reporte (std::ostream &os) const
+{
+    os << "Particion en " << m_nodosPorProceso.size () << " procesos, nodos por proceso:";
+    for (uint32_t n : m_nodosPorProceso)
+    {
+        os << " " << n;
+    }
+    os << "\n  enlaces entre procesos: " << m_enlacesCruzados << " de " << m_enlaces
+       << ", " << m_tiempoCruzado << " de " << m_tiempo << " s de enlace ("
+       << (m_tiempo > 0 ? 100.0 * m_tiempoCruzado / m_tiempo : 0.0) << "%)"
+       << "\n  distancia minima entre procesos: " << (m_enlacesCruzados > 0 ? "menos de " : "al menos ")
+       << m_alcance << " m"
+       << "\n  lookahead: " << Lookahead () * 1e6 << " us\n";
+}
+
+} // namespace tesis
+
+#endif /* TESIS_PARTICION_H */
@@ -0,0 +1,546 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TESIS_PERFIL_H
+#define TESIS_PERFIL_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/aodv-module.h"
+#include "ns3/aodv-packet.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <map>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+namespace tesis {
+
+// Tipo de un evento: la clase y la firma del metodo que ejecuta, sacadas
+// del nombre del EventImpl que genera MakeEvent
+inline std::string
+NombreEvento (const std::type_info &tipo)
+{
+    int estado = 0;
+    char *texto = abi::__cxa_demangle (tipo.name (), 0, 0, &estado);
+    std::string nombre = estado == 0 ? texto : tipo.name ();
+    std::free (texto);
+
+    std::string::size_type i = nombre.find ("MakeEvent<");
+    if (i == std::string::npos)
+    {
+        return nombre;
+    }
+    i += 10;
+    int nivel = 0;
+    std::string::size_type j = i;
+    for (; j < nombre.size (); ++j)
+    {
+        char c = nombre[j];
+        if (c == '<' || c == '(')
+        {
+            ++nivel;
+        }
+        else if (c == ')' || (c == '>' && nivel > 0))
+        {
+            --nivel;
+        }
+        else if ((c == '>' || c == ',') && nivel == 0)
+        {
+            break;
+        }
+    }
+    return nombre.substr (i, j - i);
+}
+
+// Categoria del reporte a partir del nombre del evento
+inline std::string
+CategoriaEvento (const std::string &nombre)
+{
+    static const char *reglas[][2] =
+    {
+        { "aodv", "AODV" },
+        { "Timer", "Temporizadores (AODV, NDP)" },
+        { "Tcp", "TCP" },
+        { "Application", "Aplicaciones" },
+        { "UdpClient", "Aplicaciones" },
+        { "UdpServer", "Aplicaciones" },
+        { "OnOff", "Aplicaciones" },
+        { "PacketSink", "Aplicaciones" },
+        { "Ping6", "Aplicaciones" },
+        { "Phy", "PHY wifi" },
+        { "InterferenceHelper", "PHY wifi" },
+        { "Channel", "PHY wifi" },
+        { "CanalCuadricula", "PHY wifi" },
+        { "Mac", "MAC wifi" },
+        { "Dca", "MAC wifi" },
+        { "Dcf", "MAC wifi" },
+        { "Wifi", "MAC wifi" },
+        { "Ipv4", "IP/ICMP/NDP" },
+        { "Ipv6", "IP/ICMP/NDP" },
+        { "Icmp", "IP/ICMP/NDP" },
+        { "Arp", "IP/ICMP/NDP" },
+        { "Mobility", "Movilidad" },
+        { "FlowMonitor", "FlowMonitor" },
+    };
+    for (const auto &regla : reglas)
+    {
+        if (nombre.find (regla[0]) != std::string::npos)
+        {
+            return regla[1];
+        }
+    }
+    return "Otros";
+}
+
+/*
+ * Planificador que delega en un MapScheduler y mide cada evento.
+ *
+ * DefaultSimulatorImpl llama a RemoveNext () justo antes de ejecutar cada
+ * evento, asi que el tiempo real entre dos llamadas se atribuye al evento
+ * anterior (incluye las inserciones que hizo). Los eventos cancelados se
+ * cuentan aparte: el simulador los saca de la cola pero no los ejecuta.
+ */
+class PlanificadorPerfil : public ns3::Scheduler
+{
+public:
+    struct Tipo
+    {
+        std::string nombre;
+        uint64_t eventos;
+        double segundos;
+    };
+
+    static ns3::TypeId GetTypeId ();
+
+    PlanificadorPerfil ();
+    virtual ~PlanificadorPerfil ();
+
+    virtual void Insert (const Event &ev);
+    virtual bool IsEmpty () const;
+    virtual Event PeekNext () const;
+    virtual Event RemoveNext ();
+    virtual void Remove (const Event &ev);
+
+    // Cierra la medicion del evento en curso y devuelve lo acumulado
+    const std::vector<Tipo> &GetTipos ();
+    uint64_t GetCancelados () const;
+
+    // Ultimo planificador creado por Simulator::SetScheduler
+    static PlanificadorPerfil *Actual ();
+
+private:
+    typedef std::chrono::steady_clock Reloj;
+
+    static PlanificadorPerfil *&Registro ();
+    void Cerrar (Reloj::time_point ahora);
+
+    ns3::Ptr<ns3::Scheduler> m_interno;
+    std::unordered_map<const std::type_info *, uint32_t> m_indice;
+    std::vector<Tipo> m_tipos;
+    int32_t m_enCurso;
+    Reloj::time_point m_inicio;
+    uint64_t m_cancelados;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (PlanificadorPerfil);
+
+inline ns3::TypeId
+PlanificadorPerfil::GetTypeId ()
+{
+    static ns3::TypeId tid = ns3::TypeId ("tesis::PlanificadorPerfil")
+        .SetParent<ns3::Scheduler> ()
+        .AddConstructor<PlanificadorPerfil> ();
+    return tid;
+}
+
+inline
+PlanificadorPerfil::PlanificadorPerfil ()
+  : m_interno (ns3::CreateObject<ns3::MapScheduler> ()),
+    m_enCurso (-1),
+    m_cancelados (0)
+{
+    Registro () = this;
+}
+
+inline
+PlanificadorPerfil::~PlanificadorPerfil ()
+{
+    if (Registro () == this)
+    {
+        Registro () = 0;
+    }
+}
+
+inline void
+PlanificadorPerfil::Insert (const Event &ev)
+{
+    m_interno->Insert (ev);
+}
+
+inline bool
+PlanificadorPerfil::IsEmpty () const
+{
+    return m_interno->IsEmpty ();
+}
+
+inline ns3::Scheduler::Event
+PlanificadorPerfil::PeekNext () const
+{
+    return m_interno->PeekNext ();
+}
+
+inline ns3::Scheduler::Event
+PlanificadorPerfil::RemoveNext ()
+{
+    Reloj::time_point ahora = Reloj::now ();
+    Cerrar (ahora);
+
+    Event ev = m_interno->RemoveNext ();
+    if (ev.impl->IsCancelled ())
+    {
+        ++m_cancelados;
+        return ev;
+    }
+
+    const std::type_info *tipo = &typeid (*ev.impl);
+    std::unordered_map<const std::type_info *, uint32_t>::iterator i = m_indice.find (tipo);
+    if (i == m_indice.end ())
+    {
+        Tipo nuevo = { NombreEvento (*tipo), 0, 0.0 };
+        m_tipos.push_back (nuevo);
+        i = m_indice.insert (std::make_pair (tipo, m_tipos.size () - 1)).first;
+    }
+    m_enCurso = i->second;
+    m_inicio = ahora;
+    return ev;
+}
+
+inline void
+PlanificadorPerfil::Remove (const Event &ev)
+{
+    m_interno->Remove (ev);
+}
+
+inline const std::vector<PlanificadorPerfil::Tipo> &
+PlanificadorPerfil::GetTipos ()
+{
+    Cerrar (Reloj::now ());
+    return m_tipos;
+}
+
+inline uint64_t
+PlanificadorPerfil::GetCancelados () const
+{
+    return m_cancelados;
+}
+
+inline PlanificadorPerfil *
+PlanificadorPerfil::Actual ()
+{
+    return Registro ();
+}
+
+inline PlanificadorPerfil *&
+PlanificadorPerfil::Registro ()
+{
+    static PlanificadorPerfil *actual = 0;
+    return actual;
+}
+
+inline void
+PlanificadorPerfil::Cerrar (Reloj::time_point ahora)
+{
+    if (m_enCurso >= 0)
+    {
+        Tipo &t = m_tipos[m_enCurso];
+        ++t.eventos;
+        t.segundos += std::chrono::duration<double> (ahora - m_inicio).count ();
+        m_enCurso = -1;
+    }
+}
+
+/*
+ * Perfil de ejecucion de Simulator::Run ().
+ *
+ * Iniciar () instala PlanificadorPerfil y conecta las trazas de la PHY
+ * wifi y de IP; Terminar () recoge lo medido antes de Simulator::Destroy ().
+ * Las replicas se acumulan. El reporte tiene eventos y tiempo real por
+ * categoria y por tipo, tramas transmitidas y recibidas, mensajes AODV por
+ * tipo (un RREP a difusion es un hello) y paquetes enviados por las
+ * aplicaciones.
+ */
+class Perfil
+{
+public:
+    Perfil ();
+
+    // Llamar justo antes de Simulator::Run ()
+    void Iniciar ();
+
+    // Llamar despues de Simulator::Run () y antes de Simulator::Destroy ()
+    void Terminar ();
+
+    void Reporte (std::ostream &os) const;
+
+private:
+    struct Acumulado
+    {
+        uint64_t eventos;
+        double segundos;
+    };
+
+    void TxPhy (ns3::Ptr<const ns3::Packet> paquete);
+    void RxPhy (ns3::Ptr<const ns3::Packet> paquete);
+    void RxPhyOk (ns3::Ptr<const ns3::Packet> paquete);
+    void EnvioIpv4 (const ns3::Ipv4Header &cabecera, ns3::Ptr<const ns3::Packet> paquete, uint32_t interfaz);
+    void EnvioIpv6 (const ns3::Ipv6Header &cabecera, ns3::Ptr<const ns3::Packet> paquete, uint32_t interfaz);
+    void Envio (uint8_t protocolo, ns3::Ptr<const ns3::Packet> paquete);
+
+    std::chrono::steady_clock::time_point m_inicioReal;
+    ns3::Time m_inicioSimulado;
+
+    double m_real;
+    double m_simulado;
+    uint64_t m_cancelados;
+    std::map<std::string, Acumulado> m_tipos;
+
+    uint64_t m_txPhy;
+    uint64_t m_rxPhy;
+    uint64_t m_rxPhyOk;
+    uint64_t m_envios;
+    std::map<std::string, uint64_t> m_aodv;
+};
+
+inline
+Perfil::Perfil ()
+  : m_real (0),
+    m_simulado (0),
+    m_cancelados (0),
+    m_txPhy (0),
+    m_rxPhy (0),
+    m_rxPhyOk (0),
+    m_envios (0)
+{
+}
+
+inline void
+Perfil::Iniciar ()
+{
+    ns3::ObjectFactory planificador;
+    planificador.SetTypeId (PlanificadorPerfil::GetTypeId ());
+    ns3::Simulator::SetScheduler (planificador);
+
+    std::string phy = "/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/";
+    ns3::Config::ConnectWithoutContext (phy + "PhyTxBegin", ns3::MakeCallback (&Perfil::TxPhy, this));
+    ns3::Config::ConnectWithoutContext (phy + "PhyRxBegin", ns3::MakeCallback (&Perfil::RxPhy, this));
+    ns3::Config::ConnectWithoutContext (phy + "PhyRxEnd", ns3::MakeCallback (&Perfil::RxPhyOk, this));
+    ns3::Config::ConnectWithoutContext ("/NodeList/*/$ns3::Ipv4L3Protocol/SendOutgoing",
+                                        ns3::MakeCallback (&Perfil::EnvioIpv4, this));
+    ns3::Config::ConnectWithoutContext ("/NodeList/*/$ns3::Ipv6L3Protocol/SendOutgoing",
+                                        ns3::MakeCallback (&Perfil::EnvioIpv6, this));
+
+    m_inicioSimulado = ns3::Simulator::Now ();
+    m_inicioReal = std::chrono::steady_clock::now ();
+}
+
+inline void
+Perfil::Terminar ()
+{
+    m_real += std::chrono::duration<double> (std::chrono::steady_clock::now () - m_inicioReal).count ();
+    m_simulado += (ns3::Simulator::Now () - m_inicioSimulado).GetSeconds ();
+
+    PlanificadorPerfil *planificador = PlanificadorPerfil::Actual ();
+    if (planificador == 0)
+    {
+        return;
+    }
+    for (const PlanificadorPerfil::Tipo &t : planificador->GetTipos ())
+    {
+        Acumulado &a = m_tipos[t.nombre];
+        a.eventos += t.eventos;
+        a.segundos += t.segundos;
+    }
+    m_cancelados += planificador->GetCancelados ();
+}
+
+inline void
+Perfil::TxPhy (ns3::Ptr<const ns3::Packet> paquete)
+{
+    ++m_txPhy;
+
+    ns3::Ptr<ns3::Packet> copia = paquete->Copy ();
+    ns3::WifiMacHeader mac;
+    copia->RemoveHeader (mac);
+    if (!mac.IsData ())
+    {
+        return;
+    }
+    ns3::LlcSnapHeader llc;
+    copia->RemoveHeader (llc);
+
+    bool difusion = false;
+    if (llc.GetType () == 0x0800)
+    {
+        ns3::Ipv4Header ip;
+        copia->RemoveHeader (ip);
+        if (ip.GetProtocol () != 17)
+        {
+            return;
+        }
+    }
+    else if (llc.GetType () == 0x86DD)
+    {
+        ns3::Ipv6Header ip;
+        copia->RemoveHeader (ip);
+        if (ip.GetNextHeader () != 17)
+        {
+            return;
+        }
+        difusion = ip.GetDestinationAddress ().IsMulticast ();
+    }
+    else
+    {
+        return;
+    }
+
+    ns3::UdpHeader udp;
+    copia->RemoveHeader (udp);
+    if (udp.GetDestinationPort () != 654)
+    {
+        return;
+    }
+    ns3::aodv::TypeHeader tipo;
+    copia->RemoveHeader (tipo);
+    if (!tipo.IsValid ())
+    {
+        return;
+    }
+
+    switch (tipo.Get ())
+    {
+    case ns3::aodv::AODVTYPE_RREQ:
+        ++m_aodv["RREQ"];
+        break;
+    case ns3::aodv::AODVTYPE_RREP:
+        if (llc.GetType () == 0x0800)
+        {
+            // En IPv4 el hello va a la difusion de la subred
+            ns3::aodv::RrepHeader rrep;
+            copia->RemoveHeader (rrep);
+            difusion = rrep.GetDst () == rrep.GetOrigin ();
+        }
+        ++m_aodv[difusion ? "hello" : "RREP"];
+        break;
+    case ns3::aodv::AODVTYPE_RERR:
+        ++m_aodv["RERR"];
+        break;
+    case ns3::aodv::AODVTYPE_RREP_ACK:
+        ++m_aodv["RREP-ACK"];
+        break;
+    }
+}
+
+inline void
+Perfil::RxPhy (ns3::Ptr<const ns3::Packet>)
+{
+    ++m_rxPhy;
+}
+
+inline void
+Perfil::RxPhyOk (ns3::Ptr<const ns3::Packet>)
+{
+    ++m_rxPhyOk;
+}
+
+inline void
+Perfil::EnvioIpv4 (const ns3::Ipv4Header &cabecera, ns3::Ptr<const ns3::Packet> paquete, uint32_t)
+{
+    Envio (cabecera.GetProtocol (), paquete);
+}
+
+inline void
+Perfil::EnvioIpv6 (const ns3::Ipv6Header &cabecera, ns3::Ptr<const ns3::Packet> paquete, uint32_t)
+{
+    Envio (cabecera.GetNextHeader (), paquete);
+}
+
+inline void
+Perfil::Envio (uint8_t protocolo, ns3::Ptr<const ns3::Packet> paquete)
+{
+    // Datos de las aplicaciones: TCP o UDP que no sea AODV
+    if (protocolo == 6)
+    {
+        ++m_envios;
+    }
+    else if (protocolo == 17)
+    {
+        ns3::UdpHeader udp;
+        paquete->PeekHeader (udp);
+        m_envios += udp.GetDestinationPort () != 654;
+    }
+}
+
+inline void
+Perfil::Reporte (std::ostream &os) const
+{
+    if (m_real <= 0)
+    {
+        return;
+    }
+
+    uint64_t eventos = 0;
+    std::map<std::string, Acumulado> categorias;
+    std::vector<std::pair<std::string, Acumulado> > tipos (m_tipos.begin (), m_tipos.end ());
+    for (const auto &t : tipos)
+    {
+        Acumulado &c = categorias[CategoriaEvento (t.first)];
+        c.eventos += t.second.eventos;
+        c.segundos += t.second.segundos;
+        eventos += t.second.eventos;
+    }
+
+    os << "Perfil: " << eventos << " eventos (" << m_cancelados << " cancelados) en "
+       << m_real << " s reales, " << eventos / m_real << " eventos/s, "
+       << m_simulado / m_real << " s simulados por s real\n";
+
+    os << "  Por categoria (eventos, s reales, % del tiempo):\n";
+    for (const auto &c : categorias)
+    {
+        os << "    " << c.first << ": " << c.second.eventos << ", " << c.second.segundos
+           << ", " << 100.0 * c.second.segundos / m_real << "%\n";
+    }
+
+    // Los tipos que mas tiempo consumen
+    std::sort (tipos.begin (), tipos.end (),
+               [] (const std::pair<std::string, Acumulado> &a, const std::pair<std::string, Acumulado> &b)
+               {
+                   return a.second.segundos > b.second.segundos;
+               });
+    os << "  Tipos de evento mas costosos:\n";
+    for (uint32_t i = 0; i < tipos.size () && i < 15; ++i)
+    {
+        os << "    " << tipos[i].second.eventos << ", " << tipos[i].second.segundos << " s: "
+           << tipos[i].first.substr (0, 100) << "\n";
+    }
+
+    os << "  Tramas PHY: " << m_txPhy << " transmitidas, " << m_rxPhy << " recepciones iniciadas, "
+       << m_rxPhyOk << " recibidas\n";
+    os << "  Mensajes AODV:";
+    for (const auto &m : m_aodv)
+    {
+        os << " " << m.first << " " << m.second;
+    }
+    os << "\n  Paquetes enviados por aplicaciones: " << m_envios << "\n";
+}
+
+} // namespace tesis
+
+#endif /* TESIS_PERFIL_H */
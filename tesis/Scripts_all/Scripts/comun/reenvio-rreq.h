@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TESIS_REENVIO_RREQ_H
+#define TESIS_REENVIO_RREQ_H
+
+#include "tabla-rutas6.h"
+
+#include <cstdint>
+
+namespace tesis {
+
+// Parametros del reenvio de RREQ; en el port son atributos de
+// aodv::RoutingProtocol6 que se pasan con Aodv6Helper::Set
+struct ParametrosReenvio
+{
+    enum Modo
+    {
+        // Todo RREQ nuevo se reenvia (AODV de ns-3)
+        CIEGO,
+        // Se reenvia con probabilidad (gossip)
+        PROBABILISTICO,
+        // Se espera un retardo al azar y se reenvia si se escucharon menos
+        // de umbral copias
+        CONTADOR
+    };
+
+    // RreqForwarding: Blind, Probabilistic o Counter
+    Modo modo;
+    // RreqProbability
+    double probabilidad;
+    // RreqCounterThreshold
+    uint32_t umbral;
+    // RreqAssessmentDelay: retardo maximo de la evaluacion, en pasos del
+    // simulador
+    int64_t espera;
+    // RreqBlindHops: los nodos a esta cantidad de saltos del originador o
+    // menos reenvian siempre, para que la inundacion no muera cerca de el
+    uint32_t saltosCiegos;
+
+    static ParametrosReenvio Ciego ();
+};
+
+inline ParametrosReenvio
+ParametrosReenvio::Ciego ()
+{
+    ParametrosReenvio p = { CIEGO, 1.0, 0, 0, 0 };
+    return p;
+}
+
+/*
+ * Decide si un nodo reenvia un RREQ que escucha por primera vez y no
+ * contesta, para reemplazar la inundacion ciega de AODV en redes densas.
+ *
+ * CIEGO y PROBABILISTICO deciden en el acto. CONTADOR devuelve un retardo
+ * al azar en [0, espera) (la evaluacion reemplaza al jitter de la
+ * difusion); el port cuenta con Duplicada las copias que su IdCache
+ * descarta mientras tanto y al vencer el retardo reenvia si Evaluar da
+ * true. Los RREQ pendientes viven en una TablaRutas6 indexada por
+ * (originador, id), que solo guarda los que estan en espera.
+ *
+ * El originador es el identificador de su direccion en Internador6; el
+ * azar (uniforme en [0, 1)) lo da el port con su UniformRandomVariable,
+ * asi que las corridas siguen dependiendo solo de RngRun.
+ */
+class ReenvioRreq
+{
+public:
+    enum Decision
+    {
+        REENVIAR,
+        DESCARTAR,
+        ESPERAR
+    };
+
+    explicit ReenvioRreq (const ParametrosReenvio &parametros = ParametrosReenvio::Ciego ());
+
+    // Primera copia de (originador, id), llegada en saltos saltos (1 si la
+    // mando el originador); con ESPERAR deja en espera los pasos hasta
+    // llamar a Evaluar
+    Decision Primera (uint32_t originador, uint32_t id, uint32_t saltos, double azar, int64_t &espera);
+
+    // Copia repetida de un RREQ (la que IdCache toma por duplicada)
+    void Duplicada (uint32_t originador, uint32_t id);
+
+    // Vencio la espera de (originador, id): true si hay que reenviarlo
+    bool Evaluar (uint32_t originador, uint32_t id);
+
+    const ParametrosReenvio &GetParametros () const { return m_parametros; }
+    uint64_t GetReenviados () const { return m_reenviados; }
+    uint64_t GetSuprimidos () const { return m_suprimidos; }
+
+private:
+    static uint64_t Clave (uint32_t originador, uint32_t id)
+    {
+        return (uint64_t (originador) << 32) | id;
+    }
+
+    ParametrosReenvio m_parametros;
+    // Copias escuchadas de cada RREQ en espera
+    TablaRutas6<uint32_t, uint64_t> m_pendientes;
+    uint64_t m_reenviados;
+    uint64_t m_suprimidos;
+};
+
+inline
+ReenvioRreq::ReenvioRreq (const ParametrosReenvio &parametros)
+  : m_parametros (parametros),
+    m_reenviados (0),
+    m_suprimidos (0)
+{
+}
+
+inline ReenvioRreq::Decision
+ReenvioRreq::Primera (uint32_t originador, uint32_t id, uint32_t saltos, double azar, int64_t &espera)
+{
+    if (m_parametros.modo == ParametrosReenvio::CIEGO || saltos <= m_parametros.saltosCiegos)
+    {
+        ++m_reenviados;
+        return REENVIAR;
+    }
+    if (m_parametros.modo == ParametrosReenvio::PROBABILISTICO)
+    {
+        if (azar < m_parametros.probabilidad)
+        {
+            ++m_reenviados;
+            return REENVIAR;
+        }
+        ++m_suprimidos;
+        return DESCARTAR;
+    }
+    espera = int64_t (azar * m_parametros.espera);
+    m_pendientes.Agregar (Clave (originador, id), 1);
+    return ESPERAR;
+}
+
+inline void
+ReenvioRreq::Duplicada (uint32_t originador, uint32_t id)
+{
+    uint32_t *copias = m_pendientes.Buscar (Clave (originador, id));
+    if (copias != 0)
+    {
+        ++*copias;
+    }
+}
+
+inline bool
+ReenvioRreq::Evaluar (uint32_t originador, uint32_t id)
+{
+    uint64_t clave = Clave (originador, id);
+    uint32_t *copias = m_pendientes.Buscar (clave);
+    bool reenviar = copias != 0 && *copias < m_parametros.umbral;
+    m_pendientes.Borrar (clave);
+    ++(reenviar ? m_reenviados : m_suprimidos);
+    return reenviar;
+}
+
+} // namespace tesis
+
+#endif /* TESIS_REENVIO_RREQ_H */
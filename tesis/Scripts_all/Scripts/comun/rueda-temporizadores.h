@@ -0,0 +1,325 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TESIS_RUEDA_TEMPORIZADORES_H
+#define TESIS_RUEDA_TEMPORIZADORES_H
+
+#include <cstdint>
+#include <vector>
+
+namespace tesis {
+
+/*
+ * Rueda jerarquica de temporizadores en ticks enteros.
+ *
+ * Cuatro niveles de 64 ranuras: el nivel l guarda los temporizadores que
+ * vencen entre 64^l y 64^(l+1) ticks adelante, en la ranura de los bits
+ * (6l .. 6l+5) de su vencimiento. Cuando el tick actual cruza un borde del
+ * nivel l, la ranura que corresponde se redistribuye hacia abajo; al nivel
+ * 0 solo llegan los que vencen en los proximos 64 ticks, y vencen todos
+ * los de la ranura del tick. Los que quedan a mas de 64^4 ticks esperan en
+ * una lista aparte que se revisa cada vuelta completa.
+ *
+ * Programar, Reprogramar y Cancelar son O(1) (listas doblemente enlazadas
+ * por indice sobre un arreglo de nodos reutilizados) y cada temporizador se
+ * mueve a lo sumo una vez por nivel, asi que vencer cuesta O(1) amortizado.
+ *
+ * Un temporizador vence en Avanzar al procesar su tick, nunca antes; un
+ * vencimiento en el pasado o en el tick actual se corre al siguiente.
+ *
+ * No es exacta: quien la usa pasa el plazo a ticks redondeando hacia
+ * arriba (ceil (plazo / resolucion)) y el aviso llega en [plazo, plazo +
+ * resolucion), en promedio media resolucion tarde con plazos al azar. Es
+ * el error que se acepta; las entradas guardan su plazo exacto y las
+ * consultas de vigencia lo usan, asi que solo se atrasa la accion de
+ * vencer (retirar la entrada, avisar el RERR). herramientas/temporizadores
+ * comprueba la cota y da las mismas respuestas y vencimientos que un
+ * evento por entrada.
+ */
+class RuedaTemporizadores
+{
+public:
+    typedef uint32_t Id;
+    // Enumerador y no static const: se pasa por referencia (vector, min) y
+    // un static const sin definicion fuera de la clase no enlaza sin
+    // optimizar
+    enum : Id { NINGUNO = 0xffffffff };
+
+    RuedaTemporizadores ();
+
+    // Temporizador que vence en el tick vencimiento con el dato dado
+    Id Programar (uint64_t vencimiento, uint64_t dato);
+
+    // Cambia el vencimiento de un temporizador activo
+    void Reprogramar (Id id, uint64_t vencimiento);
+
+    void Cancelar (Id id);
+
+    uint64_t GetVencimiento (Id id) const;
+    uint64_t GetDato (Id id) const;
+
+    // Ultimo tick procesado
+    uint64_t GetActual () const;
+
+    // Temporizadores activos
+    uint32_t size () const;
+
+    // Primer tick posterior al actual que Avanzar tiene que procesar: el de
+    // la proxima ranura ocupada del nivel 0 o el proximo borde del nivel 1.
+    // Sin temporizadores activos no hay ninguno (devuelve 0).
+    uint64_t Proximo () const;
+
+    // Procesa los ticks hasta hasta inclusive y llama a vencer (id, dato)
+    // por cada temporizador vencido, ya fuera de la rueda; vencer puede
+    // programar otros (el id se reutiliza despues de la llamada)
+    template <typename Vencer>
+    void Avanzar (uint64_t hasta, Vencer vencer);
+
+    // Descarta todos los temporizadores y vuelve al tick 0
+    void clear ();
+
+private:
+    static const uint32_t BITS = 6;
+    static const uint32_t RANURAS = 1 << BITS;
+    static const uint32_t NIVELES = 4;
+    // Cabeza de la lista de los que vencen despues del ultimo nivel
+    static const uint32_t FUERA = NIVELES * RANURAS;
+
+    struct Nodo
+    {
+        uint64_t vencimiento;
+        uint64_t dato;
+        Id anterior;
+        Id siguiente;
+        // Lista en la que esta (FUERA + 1 = libre)
+        uint32_t lista;
+    };
+
+    uint32_t Lista (uint64_t vencimiento) const;
+    void Enlazar (Id id);
+    void Desenlazar (Id id);
+    void Redistribuir (uint32_t lista);
+
+    std::vector<Nodo> m_nodos;
+    std::vector<Id> m_cabezas;
+    Id m_libres;
+    uint64_t m_actual;
+    uint32_t m_activos;
+};
+
+inline
+RuedaTemporizadores::RuedaTemporizadores ()
+  : m_cabezas (FUERA + 1, NINGUNO),
+    m_libres (NINGUNO),
+    m_actual (0),
+    m_activos (0)
+{
+}
+
+inline uint32_t
+RuedaTemporizadores::Lista (uint64_t vencimiento) const
+{
+    uint64_t delta = vencimiento - m_actual;
+    for (uint32_t l = 0; l < NIVELES; ++l)
+    {
+        if (delta < (uint64_t (1) << (BITS * (l + 1))))
+        {
+            return l * RANURAS + ((vencimiento >> (BITS * l)) & (RANURAS - 1));
+        }
+    }
+    return FUERA;
+}
+
+inline void
+RuedaTemporizadores::Enlazar (Id id)
+{
+    Nodo &n = m_nodos[id];
+    n.lista = Lista (n.vencimiento);
+    n.anterior = NINGUNO;
+    n.siguiente = m_cabezas[n.lista];
+    if (n.siguiente != NINGUNO)
+    {
+        m_nodos[n.siguiente].anterior = id;
+    }
+    m_cabezas[n.lista] = id;
+}
+
+inline void
+RuedaTemporizadores::Desenlazar (Id id)
+{
+    Nodo &n = m_nodos[id];
+    if (n.anterior != NINGUNO)
+    {
+        m_nodos[n.anterior].siguiente = n.siguiente;
+    }
+    else
+    {
+        m_cabezas[n.lista] = n.siguiente;
+    }
+    if (n.siguiente != NINGUNO)
+    {
+        m_nodos[n.siguiente].anterior = n.anterior;
+    }
+}
+
+inline RuedaTemporizadores::Id
+RuedaTemporizadores::Programar (uint64_t vencimiento, uint64_t dato)
+{
+    Id id = m_libres;
+    if (id != NINGUNO)
+    {
+        m_libres = m_nodos[id].siguiente;
+    }
+    else
+    {
+        id = m_nodos.size ();
+        m_nodos.push_back (Nodo ());
+    }
+    m_nodos[id].vencimiento = vencimiento > m_actual ? vencimiento : m_actual + 1;
+    m_nodos[id].dato = dato;
+    Enlazar (id);
+    ++m_activos;
+    return id;
+}
+
+inline void
+RuedaTemporizadores::Reprogramar (Id id, uint64_t vencimiento)
+{
+    Desenlazar (id);
+    m_nodos[id].vencimiento = vencimiento > m_actual ? vencimiento : m_actual + 1;
+    Enlazar (id);
+}
+
+inline void
+RuedaTemporizadores::Cancelar (Id id)
+{
+    Desenlazar (id);
+    m_nodos[id].lista = FUERA + 1;
+    m_nodos[id].siguiente = m_libres;
+    m_libres = id;
+    --m_activos;
+}
+
+inline uint64_t
+RuedaTemporizadores::GetVencimiento (Id id) const
+{
+    return m_nodos[id].vencimiento;
+}
+
+inline uint64_t
+RuedaTemporizadores::GetDato (Id id) const
+{
+    return m_nodos[id].dato;
+}
+
+inline uint64_t
+RuedaTemporizadores::GetActual () const
+{
+    return m_actual;
+}
+
+inline uint32_t
+RuedaTemporizadores::size () const
+{
+    return m_activos;
+}
+
+inline uint64_t
+RuedaTemporizadores::Proximo () const
+{
+    if (m_activos == 0)
+    {
+        return 0;
+    }
+    uint64_t borde = ((m_actual >> BITS) + 1) << BITS;
+    for (uint64_t t = m_actual + 1; t < borde; ++t)
+    {
+        if (m_cabezas[t & (RANURAS - 1)] != NINGUNO)
+        {
+            return t;
+        }
+    }
+    return borde;
+}
+
+inline void
+RuedaTemporizadores::Redistribuir (uint32_t lista)
+{
+    Id id = m_cabezas[lista];
+    m_cabezas[lista] = NINGUNO;
+    while (id != NINGUNO)
+    {
+        Id siguiente = m_nodos[id].siguiente;
+        Enlazar (id);
+        id = siguiente;
+    }
+}
+
+template <typename Vencer>
+void
+RuedaTemporizadores::Avanzar (uint64_t hasta, Vencer vencer)
+{
+    while (m_actual < hasta)
+    {
+        uint64_t t = m_actual + 1;
+        if (m_activos == 0)
+        {
+            m_actual = hasta;
+            return;
+        }
+        // Saltar ticks sin nada que hacer
+        if (t & (RANURAS - 1))
+        {
+            uint64_t proximo = Proximo ();
+            if (proximo > hasta)
+            {
+                m_actual = hasta;
+                return;
+            }
+            t = proximo;
+        }
+        m_actual = t;
+
+        // Bordes de nivel: se baja primero el nivel 1 y solo si su indice
+        // tambien volvio a cero, el 2, y asi
+        for (uint32_t l = 1; l < NIVELES; ++l)
+        {
+            if (t & ((uint64_t (1) << (BITS * l)) - 1))
+            {
+                break;
+            }
+            Redistribuir (l * RANURAS + ((t >> (BITS * l)) & (RANURAS - 1)));
+            if (l == NIVELES - 1 && (t & ((uint64_t (1) << (BITS * NIVELES)) - 1)) == 0)
+            {
+                Redistribuir (FUERA);
+            }
+        }
+
+        // Vencen todos los de la ranura del tick
+        uint32_t ranura = t & (RANURAS - 1);
+        while (m_cabezas[ranura] != NINGUNO)
+        {
+            Id id = m_cabezas[ranura];
+            Desenlazar (id);
+            uint64_t dato = m_nodos[id].dato;
+            m_nodos[id].lista = FUERA + 1;
+            --m_activos;
+            vencer (id, dato);
+            m_nodos[id].siguiente = m_libres;
+            m_libres = id;
+        }
+    }
+}
+
+inline void
+RuedaTemporizadores::clear ()
+{
+    m_nodos.clear ();
+    m_cabezas.assign (FUERA + 1, NINGUNO);
+    m_libres = NINGUNO;
+    m_actual = 0;
+    m_activos = 0;
+}
+
+} // namespace tesis
+
+#endif /* TESIS_RUEDA_TEMPORIZADORES_H */
@@ -0,0 +1,301 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TESIS_RUTAS_MULTIPLES_H
+#define TESIS_RUTAS_MULTIPLES_H
+
+#include "tabla-rutas6.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace tesis {
+
+// Un camino hacia un destino
+struct Camino
+{
+    // Vecino por el que sale
+    uint32_t siguiente;
+    // Ultimo nodo antes del destino; dos caminos con el mismo no se guardan
+    uint32_t ultimo;
+    uint32_t saltos;
+    int64_t vencimiento;
+};
+
+/*
+ * Tabla de rutas de varios caminos por destino al estilo de AOMDV (Marina
+ * y Das), para un modo multicamino de aodv::RoutingProtocol6.
+ *
+ * Cada destino guarda su numero de secuencia y hasta caminos caminos
+ * ordenados por saltos; el primero es la ruta activa. Los caminos se
+ * aprenden de todas las copias de un RREQ (hacia el originador) y de los
+ * RREP, no solo de la primera. Reglas de AOMDV:
+ *
+ *  - un numero de secuencia mas nuevo vacia la lista; uno viejo se ignora;
+ *  - sin bucles: con el mismo numero solo se acepta un camino de un vecino
+ *    que anuncia menos saltos que los que el nodo ya anuncio (Anunciar fija
+ *    ese valor la primera vez que el nodo reenvia un RREQ o RREP para el
+ *    destino, al mayor de sus caminos);
+ *  - disjuncion de enlaces: los caminos tienen distinto vecino siguiente y
+ *    distinto ultimo nodo antes del destino (el RREQ lleva el primer salto
+ *    y el RREP el ultimo).
+ *
+ * Cuando falla un envio por un vecino, Fallo quita ese camino y la ruta
+ * pasa al siguiente sin inundar; solo si no queda ninguno hace falta el
+ * RERR y un descubrimiento nuevo. Con caminos = 1 es la tabla de AODV.
+ *
+ * Los nodos son identificadores de Internador6 y el tiempo, pasos enteros
+ * del simulador (Time::GetTimeStep). Los punteros que devuelve Buscar
+ * dejan de valer al actualizar la tabla.
+ */
+class RutasMultiples
+{
+public:
+    static const uint32_t MAXIMO = 4;
+    static const uint32_t INFINITO = 0xffffffff;
+
+    // caminos: MaxPaths, hasta MAXIMO; vida: ActiveRouteTimeout en pasos
+    RutasMultiples (uint32_t caminos, int64_t vida);
+
+    // Aviso de destino que llega de vecino con su numero de secuencia, los
+    // saltos que anuncia vecino y el ultimo nodo antes del destino (vecino
+    // mismo si es el destino); true si se agrego el camino
+    bool Actualizar (uint32_t destino, uint32_t secuencia, uint32_t vecino, uint32_t saltos, uint32_t ultimo,
+                     int64_t ahora);
+
+    // Saltos que el nodo anuncia para destino al reenviar; INFINITO si no
+    // tiene camino
+    uint32_t Anunciar (uint32_t destino);
+
+    // Camino vigente numero indice por saltos (0: la ruta activa), 0 si no
+    // hay
+    const Camino *Buscar (uint32_t destino, int64_t ahora, uint32_t indice = 0);
+
+    // Caminos vigentes hacia destino
+    uint32_t GetCaminos (uint32_t destino, int64_t ahora);
+
+    // Un paquete salio hacia destino: renueva la vida de todos sus caminos,
+    // como la de la entrada de ns-3
+    void Usar (uint32_t destino, int64_t ahora);
+
+    // Fallo el envio a destino por vecino: quita el camino; true si la ruta
+    // paso a otro camino
+    bool Fallo (uint32_t destino, uint32_t vecino);
+
+    // Se perdio el vecino (HELLO vencido o RERR): quita sus caminos y deja
+    // en sinRuta los destinos que se quedaron sin ninguno
+    void PerderVecino (uint32_t vecino, std::vector<uint32_t> &sinRuta);
+
+    // Fallos resueltos cambiando de camino
+    uint64_t GetCambios () const { return m_cambios; }
+
+    uint32_t size () const { return m_destinos.size (); }
+
+private:
+    struct Destino
+    {
+        uint32_t secuencia;
+        uint32_t anunciado;
+        uint32_t cantidad;
+        Camino caminos[MAXIMO];
+    };
+
+    static void Quitar (Destino &d, uint32_t i);
+    static void Purgar (Destino &d, int64_t ahora);
+
+    uint32_t m_maximo;
+    int64_t m_vida;
+    TablaRutas6<Destino, uint32_t> m_destinos;
+    uint64_t m_cambios;
+};
+
+inline
+RutasMultiples::RutasMultiples (uint32_t caminos, int64_t vida)
+  : m_maximo (caminos < 1 ? 1 : caminos > MAXIMO ? MAXIMO : caminos),
+    m_vida (vida),
+    m_cambios (0)
+{
+}
+
+inline void
+RutasMultiples::Quitar (Destino &d, uint32_t i)
+{
+    for (; i + 1 < d.cantidad; ++i)
+    {
+        d.caminos[i] = d.caminos[i + 1];
+    }
+    --d.cantidad;
+}
+
+inline void
+RutasMultiples::Purgar (Destino &d, int64_t ahora)
+{
+    for (uint32_t i = d.cantidad; i-- > 0; )
+    {
+        if (d.caminos[i].vencimiento < ahora)
+        {
+            Quitar (d, i);
+        }
+    }
+}
+
+inline bool
+RutasMultiples::Actualizar (uint32_t destino, uint32_t secuencia, uint32_t vecino, uint32_t saltos,
+                            uint32_t ultimo, int64_t ahora)
+{
+    Destino *d = m_destinos.Buscar (destino);
+    if (d == 0)
+    {
+        Destino nuevo = Destino ();
+        nuevo.secuencia = secuencia;
+        nuevo.anunciado = INFINITO;
+        m_destinos.Agregar (destino, nuevo);
+        d = m_destinos.Buscar (destino);
+    }
+    else if (int32_t (secuencia - d->secuencia) > 0)
+    {
+        d->secuencia = secuencia;
+        d->anunciado = INFINITO;
+        d->cantidad = 0;
+    }
+    else if (secuencia != d->secuencia)
+    {
+        return false;
+    }
+    Purgar (*d, ahora);
+    if (saltos >= d->anunciado)
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < d->cantidad; ++i)
+    {
+        Camino &c = d->caminos[i];
+        if (c.siguiente == vecino && c.ultimo == ultimo && c.saltos == saltos + 1)
+        {
+            // El mismo camino otra vez
+            c.vencimiento = ahora + m_vida;
+            return false;
+        }
+        if (c.siguiente == vecino || c.ultimo == ultimo)
+        {
+            return false;
+        }
+    }
+    if (d->cantidad == m_maximo)
+    {
+        // Llena: solo entra si es mas corto que el peor
+        if (d->caminos[d->cantidad - 1].saltos <= saltos + 1)
+        {
+            return false;
+        }
+        --d->cantidad;
+    }
+    uint32_t i = d->cantidad++;
+    for (; i > 0 && d->caminos[i - 1].saltos > saltos + 1; --i)
+    {
+        d->caminos[i] = d->caminos[i - 1];
+    }
+    Camino c = { vecino, ultimo, saltos + 1, ahora + m_vida };
+    d->caminos[i] = c;
+    return true;
+}
+
+inline uint32_t
+RutasMultiples::Anunciar (uint32_t destino)
+{
+    Destino *d = m_destinos.Buscar (destino);
+    if (d == 0 || d->cantidad == 0)
+    {
+        return INFINITO;
+    }
+    if (d->anunciado == INFINITO)
+    {
+        d->anunciado = d->caminos[d->cantidad - 1].saltos;
+    }
+    return d->anunciado;
+}
+
+inline const Camino *
+RutasMultiples::Buscar (uint32_t destino, int64_t ahora, uint32_t indice)
+{
+    Destino *d = m_destinos.Buscar (destino);
+    if (d == 0)
+    {
+        return 0;
+    }
+    Purgar (*d, ahora);
+    return indice < d->cantidad ? &d->caminos[indice] : 0;
+}
+
+inline uint32_t
+RutasMultiples::GetCaminos (uint32_t destino, int64_t ahora)
+{
+    Destino *d = m_destinos.Buscar (destino);
+    if (d == 0)
+    {
+        return 0;
+    }
+    Purgar (*d, ahora);
+    return d->cantidad;
+}
+
+inline void
+RutasMultiples::Usar (uint32_t destino, int64_t ahora)
+{
+    Destino *d = m_destinos.Buscar (destino);
+    for (uint32_t i = 0; d != 0 && i < d->cantidad; ++i)
+    {
+        d->caminos[i].vencimiento = std::max (d->caminos[i].vencimiento, ahora + m_vida);
+    }
+}
+
+inline bool
+RutasMultiples::Fallo (uint32_t destino, uint32_t vecino)
+{
+    Destino *d = m_destinos.Buscar (destino);
+    if (d == 0)
+    {
+        return false;
+    }
+    uint32_t i = 0;
+    while (i < d->cantidad && d->caminos[i].siguiente != vecino)
+    {
+        ++i;
+    }
+    if (i == d->cantidad)
+    {
+        return d->cantidad > 0;
+    }
+    Quitar (*d, i);
+    if (d->cantidad == 0)
+    {
+        return false;
+    }
+    ++m_cambios;
+    return true;
+}
+
+inline void
+RutasMultiples::PerderVecino (uint32_t vecino, std::vector<uint32_t> &sinRuta)
+{
+    for (TablaRutas6<Destino, uint32_t>::iterator e = m_destinos.begin (); e != m_destinos.end (); ++e)
+    {
+        Destino &d = e->valor;
+        for (uint32_t i = 0; i < d.cantidad; ++i)
+        {
+            if (d.caminos[i].siguiente == vecino)
+            {
+                Quitar (d, i);
+                if (d.cantidad == 0)
+                {
+                    sinRuta.push_back (e->destino);
+                }
+                break;
+            }
+        }
+    }
+}
+
+} // namespace tesis
+
+#endif /* TESIS_RUTAS_MULTIPLES_H */
@@ -0,0 +1,333 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TESIS_TABLA_RUTAS6_H
+#define TESIS_TABLA_RUTAS6_H
+
+#include <cstdint>
+#include <vector>
+
+namespace tesis {
+
+// Direccion IPv6 como dos palabras de 64 bits en orden de red, para
+// comparar y dispersar sin recorrer los 16 bytes
+struct Direccion6
+{
+    uint64_t alto;
+    uint64_t bajo;
+
+    static Direccion6 Desde (const uint8_t bytes[16]);
+
+    // Cualquier tipo con GetBytes (uint8_t[16]), como ns3::Ipv6Address
+    template <typename Direccion>
+    static Direccion6 De (const Direccion &direccion);
+
+    bool operator== (const Direccion6 &o) const { return alto == o.alto && bajo == o.bajo; }
+    bool operator!= (const Direccion6 &o) const { return !(*this == o); }
+    // Mismo orden que ns3::Ipv6Address (memcmp de los bytes)
+    bool operator< (const Direccion6 &o) const { return alto != o.alto ? alto < o.alto : bajo < o.bajo; }
+};
+
+inline Direccion6
+Direccion6::Desde (const uint8_t bytes[16])
+{
+    Direccion6 d = { 0, 0 };
+    for (int i = 0; i < 8; ++i)
+    {
+        d.alto = (d.alto << 8) | bytes[i];
+        d.bajo = (d.bajo << 8) | bytes[i + 8];
+    }
+    return d;
+}
+
+template <typename Direccion>
+inline Direccion6
+Direccion6::De (const Direccion &direccion)
+{
+    uint8_t bytes[16];
+    direccion.GetBytes (bytes);
+    return Desde (bytes);
+}
+
+// Dispersion de 64 bits: las direcciones de una red ad hoc solo difieren en
+// los ultimos bytes (fe80::200:ff:fe00:N), asi que todo el valor se mezcla
+// hacia los bits altos, que son los que elige la ranura
+inline uint64_t
+Dispersar (const Direccion6 &d)
+{
+    uint64_t h = d.bajo ^ (d.alto * 0x9E3779B97F4A7C15ULL);
+    h ^= h >> 32;
+    h *= 0xD6E8FEB86659FD93ULL;
+    h ^= h >> 32;
+    h *= 0xD6E8FEB86659FD93ULL;
+    return h ^ (h >> 29);
+}
+
+// Identificadores densos (direcciones internadas): basta una multiplicacion
+inline uint64_t
+Dispersar (uint32_t id)
+{
+    return (id + 1) * 0x9E3779B97F4A7C15ULL;
+}
+
+// Pares de identificadores en una clave (originador << 32 | id de RREQ)
+inline uint64_t
+Dispersar (uint64_t par)
+{
+    uint64_t h = par * 0x9E3779B97F4A7C15ULL;
+    return h ^ (h >> 29);
+}
+
+/*
+ * Tabla de rutas IPv6 con direccionamiento abierto, pensada como reemplazo
+ * del std::map<Ipv6Address, ...> de la tabla de aodv::RoutingProtocol6.
+ *
+ * Las entradas viven contiguas en un vector (recorrerlas para purgar es
+ * lineal y sin saltos de puntero) y un arreglo aparte de ranuras, potencia
+ * de dos con carga <= 1/2, guarda el indice de cada entrada y 32 bits de su
+ * dispersion, asi que una busqueda casi nunca compara una direccion que no
+ * es la buscada. Sondeo lineal; al borrar, la ultima entrada ocupa el
+ * hueco y las ranuras siguientes se corren hacia atras (sin lapidas).
+ *
+ * La clave es la direccion o, con las direcciones internadas, su
+ * identificador de 32 bits (Clave = uint32_t).
+ *
+ * Los punteros que devuelve Buscar dejan de valer al agregar o borrar.
+ */
+template <typename Valor, typename Clave = Direccion6>
+class TablaRutas6
+{
+public:
+    struct Entrada
+    {
+        Clave destino;
+        Valor valor;
+    };
+
+    typedef typename std::vector<Entrada>::iterator iterator;
+    typedef typename std::vector<Entrada>::const_iterator const_iterator;
+
+    TablaRutas6 ();
+
+    Valor *Buscar (const Clave &destino);
+    const Valor *Buscar (const Clave &destino) const;
+
+    // Agrega la entrada; false (sin cambios) si el destino ya estaba
+    bool Agregar (const Clave &destino, const Valor &valor);
+
+    // false si el destino no estaba
+    bool Borrar (const Clave &destino);
+
+    // Borra las entradas para las que borrar (entrada) es verdadero
+    template <typename Predicado>
+    void BorrarSi (Predicado borrar);
+
+    void clear ();
+    uint32_t size () const { return m_entradas.size (); }
+    bool empty () const { return m_entradas.empty (); }
+
+    // Bytes reservados por las entradas y las ranuras
+    uint64_t GetMemoria () const;
+
+    iterator begin () { return m_entradas.begin (); }
+    iterator end () { return m_entradas.end (); }
+    const_iterator begin () const { return m_entradas.begin (); }
+    const_iterator end () const { return m_entradas.end (); }
+
+private:
+    // indice + 1 en m_entradas (0 = libre) y parte alta de la dispersion
+    struct Ranura
+    {
+        uint32_t indice;
+        uint32_t etiqueta;
+    };
+
+    // Ranura del destino, o la libre donde iria
+    uint32_t Ubicar (const Clave &destino, uint64_t h) const;
+    uint32_t Inicial (uint64_t h) const;
+    void Crecer ();
+    void BorrarRanura (uint32_t r);
+
+    std::vector<Entrada> m_entradas;
+    std::vector<Ranura> m_ranuras;
+    uint32_t m_mascara;
+};
+
+template <typename Valor, typename Clave>
+TablaRutas6<Valor, Clave>::TablaRutas6 ()
+  : m_ranuras (16, Ranura { 0, 0 }),
+    m_mascara (15)
+{
+}
+
+template <typename Valor, typename Clave>
+inline uint32_t
+TablaRutas6<Valor, Clave>::Inicial (uint64_t h) const
+{
+    return uint32_t (h >> 32) & m_mascara;
+}
+
+template <typename Valor, typename Clave>
+inline uint32_t
+TablaRutas6<Valor, Clave>::Ubicar (const Clave &destino, uint64_t h) const
+{
+    uint32_t etiqueta = uint32_t (h);
+    uint32_t r = Inicial (h);
+    while (m_ranuras[r].indice != 0)
+    {
+        if (m_ranuras[r].etiqueta == etiqueta && m_entradas[m_ranuras[r].indice - 1].destino == destino)
+        {
+            return r;
+        }
+        r = (r + 1) & m_mascara;
+    }
+    return r;
+}
+
+template <typename Valor, typename Clave>
+inline Valor *
+TablaRutas6<Valor, Clave>::Buscar (const Clave &destino)
+{
+    uint32_t r = Ubicar (destino, Dispersar (destino));
+    return m_ranuras[r].indice != 0 ? &m_entradas[m_ranuras[r].indice - 1].valor : 0;
+}
+
+template <typename Valor, typename Clave>
+inline const Valor *
+TablaRutas6<Valor, Clave>::Buscar (const Clave &destino) const
+{
+    uint32_t r = Ubicar (destino, Dispersar (destino));
+    return m_ranuras[r].indice != 0 ? &m_entradas[m_ranuras[r].indice - 1].valor : 0;
+}
+
+template <typename Valor, typename Clave>
+bool
+TablaRutas6<Valor, Clave>::Agregar (const Clave &destino, const Valor &valor)
+{
+    uint64_t h = Dispersar (destino);
+    uint32_t r = Ubicar (destino, h);
+    if (m_ranuras[r].indice != 0)
+    {
+        return false;
+    }
+    Entrada e = { destino, valor };
+    m_entradas.push_back (e);
+    m_ranuras[r].indice = m_entradas.size ();
+    m_ranuras[r].etiqueta = uint32_t (h);
+    if (2 * m_entradas.size () > m_ranuras.size ())
+    {
+        Crecer ();
+    }
+    return true;
+}
+
+template <typename Valor, typename Clave>
+void
+TablaRutas6<Valor, Clave>::Crecer ()
+{
+    m_ranuras.assign (2 * m_ranuras.size (), Ranura { 0, 0 });
+    m_mascara = m_ranuras.size () - 1;
+    for (uint32_t i = 0; i < m_entradas.size (); ++i)
+    {
+        uint64_t h = Dispersar (m_entradas[i].destino);
+        uint32_t r = Inicial (h);
+        while (m_ranuras[r].indice != 0)
+        {
+            r = (r + 1) & m_mascara;
+        }
+        m_ranuras[r].indice = i + 1;
+        m_ranuras[r].etiqueta = uint32_t (h);
+    }
+}
+
+template <typename Valor, typename Clave>
+void
+TablaRutas6<Valor, Clave>::BorrarRanura (uint32_t r)
+{
+    // La ultima entrada pasa al hueco; se corrige su ranura
+    uint32_t hueco = m_ranuras[r].indice - 1;
+    uint32_t ultima = m_entradas.size () - 1;
+    if (hueco != ultima)
+    {
+        uint32_t s = Ubicar (m_entradas[ultima].destino, Dispersar (m_entradas[ultima].destino));
+        m_ranuras[s].indice = hueco + 1;
+        m_entradas[hueco] = m_entradas[ultima];
+    }
+    m_entradas.pop_back ();
+
+    // Correr hacia atras las ranuras del mismo grupo que quedarian
+    // inalcanzables detras del hueco
+    uint32_t libre = r;
+    uint32_t s = (r + 1) & m_mascara;
+    while (m_ranuras[s].indice != 0)
+    {
+        uint32_t inicial = Inicial (Dispersar (m_entradas[m_ranuras[s].indice - 1].destino));
+        // La entrada en s puede ir a libre si su inicial no esta en (libre, s]
+        if (((s - inicial) & m_mascara) >= ((s - libre) & m_mascara))
+        {
+            m_ranuras[libre] = m_ranuras[s];
+            libre = s;
+        }
+        s = (s + 1) & m_mascara;
+    }
+    m_ranuras[libre].indice = 0;
+}
+
+template <typename Valor, typename Clave>
+bool
+TablaRutas6<Valor, Clave>::Borrar (const Clave &destino)
+{
+    uint32_t r = Ubicar (destino, Dispersar (destino));
+    if (m_ranuras[r].indice == 0)
+    {
+        return false;
+    }
+    BorrarRanura (r);
+    return true;
+}
+
+template <typename Valor, typename Clave>
+template <typename Predicado>
+void
+TablaRutas6<Valor, Clave>::BorrarSi (Predicado borrar)
+{
+    // Compactar las entradas y reconstruir las ranuras de una vez
+    uint32_t quedan = 0;
+    for (uint32_t i = 0; i < m_entradas.size (); ++i)
+    {
+        if (!borrar (m_entradas[i]))
+        {
+            if (quedan != i)
+            {
+                m_entradas[quedan] = m_entradas[i];
+            }
+            ++quedan;
+        }
+    }
+    if (quedan == m_entradas.size ())
+    {
+        return;
+    }
+    m_entradas.resize (quedan);
+    m_ranuras.assign (m_ranuras.size () / 2, Ranura { 0, 0 });
+    Crecer ();
+}
+
+template <typename Valor, typename Clave>
+uint64_t
+TablaRutas6<Valor, Clave>::GetMemoria () const
+{
+    return m_entradas.capacity () * sizeof (Entrada) + m_ranuras.capacity () * sizeof (Ranura);
+}
+
+template <typename Valor, typename Clave>
+void
+TablaRutas6<Valor, Clave>::clear ()
+{
+    m_entradas.clear ();
+    m_ranuras.assign (16, Ranura { 0, 0 });
+    m_mascara = 15;
+}
+
+} // namespace tesis
+
+#endif /* TESIS_TABLA_RUTAS6_H */
@@ -0,0 +1,482 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TESIS_TRAYECTORIAS_H
+#define TESIS_TRAYECTORIAS_H
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace tesis {
+
+// Punto de paso de una trayectoria lineal por tramos
+struct Punto
+{
+    double t;
+    double x;
+    double y;
+};
+
+// Puntos de paso de un nodo, ordenados por tiempo (vista sin copia)
+class Recorrido
+{
+public:
+    Recorrido (const Punto *inicio, const Punto *fin) : m_inicio (inicio), m_fin (fin) {}
+
+    const Punto *begin () const { return m_inicio; }
+    const Punto *end () const { return m_fin; }
+    uint64_t size () const { return m_fin - m_inicio; }
+    bool empty () const { return m_inicio == m_fin; }
+    const Punto &front () const { return *m_inicio; }
+    const Punto &back () const { return *(m_fin - 1); }
+    const Punto &operator[] (uint64_t i) const { return m_inicio[i]; }
+
+private:
+    const Punto *m_inicio;
+    const Punto *m_fin;
+};
+
+/*
+ * Trayectorias de todos los nodos de un escenario en memoria.
+ *
+ * Se cargan una sola vez desde una traza ns-2 (.ns_movements) o desde su
+ * version compilada (.tray) y se pueden instalar en cada nueva simulacion
+ * sin volver a leer el archivo. La conversion sigue la semantica de
+ * Ns2MobilityHelper: "setdest" mueve al nodo en linea recta a velocidad
+ * constante desde su posicion actual, un nuevo "setdest" antes de llegar
+ * corta el tramo en curso y velocidad 0 detiene al nodo.
+ *
+ * El formato compilado es la misma representacion que se usa en memoria,
+ * asi que se carga con mmap sin interpretar nada:
+ *
+ *   "TESISTRY"  uint32 version  uint32 nodos  uint64 puntos
+ *   uint64 inicio[nodos + 1]    indice del primer punto de cada nodo
+ *   Punto puntos[puntos]        t, x, y en double
+ *
+ * en el orden de bytes de la maquina que lo escribio.
+ */
+class Trayectorias
+{
+public:
+    Trayectorias ();
+    ~Trayectorias ();
+
+    // Lee una traza compilada o ns-2 segun su contenido, devuelve false si
+    // no se pudo abrir o no es valida
+    bool Leer (const std::string &archivo);
+
+    // Lee una traza ns-2, devuelve false si no se pudo abrir
+    bool LeerNs2 (const std::string &archivo);
+
+    // Proyecta una traza compilada en memoria, devuelve false si no es valida
+    bool LeerCompilada (const std::string &archivo);
+
+    // Toma trayectorias ya construidas: los puntos del nodo n son
+    // puntos[indices[n]] .. puntos[indices[n + 1] - 1]
+    void Asignar (std::vector<uint64_t> &indices, std::vector<Punto> &puntos);
+
+    // Escribe las trayectorias en formato compilado
+    bool EscribirCompilada (const std::string &archivo) const;
+
+    // Numero de nodos con trayectoria
+    uint32_t GetNNodos () const;
+
+    // Numero total de puntos de paso
+    uint64_t GetNPuntos () const;
+
+    // Indica si el nodo tiene trayectoria en la traza
+    bool Tiene (uint32_t nodo) const;
+
+    // Puntos de paso del nodo, ordenados por tiempo
+    Recorrido Get (uint32_t nodo) const;
+
+    // Posicion del nodo en el instante t (busqueda binaria en sus puntos);
+    // el origen si el nodo no tiene trayectoria, como la posicion inicial
+    // de un MobilityModel
+    Punto Posicion (uint32_t nodo, double t) const;
+
+private:
+    struct Destino
+    {
+        double t;
+        double x;
+        double y;
+        double velocidad;
+    };
+
+    struct Cabecera
+    {
+        char magia[8];
+        uint32_t version;
+        uint32_t nodos;
+        uint64_t puntos;
+    };
+
+    Trayectorias (const Trayectorias &);
+    Trayectorias &operator= (const Trayectorias &);
+
+    void Liberar ();
+    // Cabecera e indices de una traza compilada de tamano bytes
+    static bool Validar (const Cabecera *cabecera, uint64_t tamano);
+    static void Agregar (std::vector<Punto> &puntos, double t, double x, double y);
+    static void Construir (double x0, double y0, const std::vector<Destino> &destinos,
+                           std::vector<Punto> &puntos);
+
+    // Traza ns-2 leida: los datos viven en los vectores
+    std::vector<uint64_t> m_indices;
+    std::vector<Punto> m_almacen;
+
+    // Traza compilada: los datos viven en la proyeccion
+    void *m_proyeccion;
+    size_t m_tamano;
+
+    const uint64_t *m_inicio;
+    const Punto *m_puntos;
+    uint32_t m_nodos;
+};
+
+inline
+Trayectorias::Trayectorias ()
+  : m_proyeccion (0),
+    m_tamano (0),
+    m_inicio (0),
+    m_puntos (0),
+    m_nodos (0)
+{
+}
+
+inline
+Trayectorias::~Trayectorias ()
+{
+    Liberar ();
+}
+
+inline void
+Trayectorias::Liberar ()
+{
+    if (m_proyeccion != 0)
+    {
+        munmap (m_proyeccion, m_tamano);
+        m_proyeccion = 0;
+        m_tamano = 0;
+    }
+    m_indices.clear ();
+    m_almacen.clear ();
+    m_inicio = 0;
+    m_puntos = 0;
+    m_nodos = 0;
+}
+
+inline bool
+Trayectorias::Leer (const std::string &archivo)
+{
+    char magia[8] = { 0 };
+    std::ifstream is (archivo.c_str (), std::ios::binary);
+    if (is.read (magia, sizeof (magia)) && std::memcmp (magia, "TESISTRY", 8) == 0)
+    {
+        return LeerCompilada (archivo);
+    }
+    return LeerNs2 (archivo);
+}
+
+inline bool
+Trayectorias::LeerNs2 (const std::string &archivo)
+{
+    std::ifstream is (archivo.c_str ());
+    if (!is)
+    {
+        return false;
+    }
+    Liberar ();
+
+    std::vector<double> x0, y0;
+    std::vector<bool> definido;
+    std::vector<std::vector<Destino> > destinos;
+
+    std::string linea;
+    while (std::getline (is, linea))
+    {
+        std::string::size_type i = linea.find_first_not_of (" \t");
+        if (i == std::string::npos || linea[i] == '#')
+        {
+            continue;
+        }
+
+        unsigned nodo;
+        char eje;
+        double valor;
+        Destino d;
+        if (std::sscanf (linea.c_str () + i, "$node_(%u) set %c_ %lf", &nodo, &eje, &valor) == 3)
+        {
+            if (nodo >= definido.size ())
+            {
+                x0.resize (nodo + 1, 0.0);
+                y0.resize (nodo + 1, 0.0);
+                definido.resize (nodo + 1, false);
+                destinos.resize (nodo + 1);
+            }
+            if (eje == 'X')
+            {
+                x0[nodo] = valor;
+            }
+            else if (eje == 'Y')
+            {
+                y0[nodo] = valor;
+            }
+            definido[nodo] = true;
+        }
+        else if (std::sscanf (linea.c_str () + i, "$ns_ at %lf \"$node_(%u) setdest %lf %lf %lf",
+                              &d.t, &nodo, &d.x, &d.y, &d.velocidad) == 5)
+        {
+            if (nodo >= definido.size ())
+            {
+                x0.resize (nodo + 1, 0.0);
+                y0.resize (nodo + 1, 0.0);
+                definido.resize (nodo + 1, false);
+                destinos.resize (nodo + 1);
+            }
+            definido[nodo] = true;
+            destinos[nodo].push_back (d);
+        }
+    }
+
+    m_indices.assign (1, 0);
+    std::vector<Punto> puntos;
+    for (uint32_t n = 0; n < definido.size (); ++n)
+    {
+        if (definido[n])
+        {
+            puntos.clear ();
+            Construir (x0[n], y0[n], destinos[n], puntos);
+            m_almacen.insert (m_almacen.end (), puntos.begin (), puntos.end ());
+        }
+        m_indices.push_back (m_almacen.size ());
+    }
+
+    m_nodos = definido.size ();
+    m_inicio = m_indices.data ();
+    m_puntos = m_almacen.data ();
+    return true;
+}
+
+inline bool
+Trayectorias::LeerCompilada (const std::string &archivo)
+{
+    int fd = open (archivo.c_str (), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    if (fstat (fd, &info) != 0 || size_t (info.st_size) < sizeof (Cabecera))
+    {
+        close (fd);
+        return false;
+    }
+    void *proyeccion = mmap (0, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close (fd);
+    if (proyeccion == MAP_FAILED)
+    {
+        return false;
+    }
+
+    const Cabecera *cabecera = static_cast<const Cabecera *> (proyeccion);
+    if (!Validar (cabecera, info.st_size))
+    {
+        munmap (proyeccion, info.st_size);
+        return false;
+    }
+
+    Liberar ();
+    m_proyeccion = proyeccion;
+    m_tamano = info.st_size;
+    m_nodos = cabecera->nodos;
+    m_inicio = reinterpret_cast<const uint64_t *> (cabecera + 1);
+    m_puntos = reinterpret_cast<const Punto *> (m_inicio + m_nodos + 1);
+    return true;
+}
+
+inline bool
+Trayectorias::Validar (const Cabecera *cabecera, uint64_t tamano)
+{
+    if (std::memcmp (cabecera->magia, "TESISTRY", 8) != 0 || cabecera->version != 1)
+    {
+        return false;
+    }
+    // Los tamanos se comparan por cantidad de elementos para que una
+    // cabecera corrupta no desborde la cuenta
+    uint64_t resto = tamano - sizeof (Cabecera);
+    uint64_t indices = uint64_t (cabecera->nodos) + 1;
+    if (resto / sizeof (uint64_t) < indices)
+    {
+        return false;
+    }
+    resto -= indices * sizeof (uint64_t);
+    if (resto % sizeof (Punto) != 0 || resto / sizeof (Punto) != cabecera->puntos)
+    {
+        return false;
+    }
+    // Una traza truncada o vieja puede tener el tamano justo y los indices
+    // rotos: tienen que empezar en 0, no bajar y terminar en puntos
+    const uint64_t *inicio = reinterpret_cast<const uint64_t *> (cabecera + 1);
+    if (inicio[0] != 0 || inicio[cabecera->nodos] != cabecera->puntos)
+    {
+        return false;
+    }
+    for (uint32_t n = 0; n < cabecera->nodos; ++n)
+    {
+        if (inicio[n + 1] < inicio[n])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline void
+Trayectorias::Asignar (std::vector<uint64_t> &indices, std::vector<Punto> &puntos)
+{
+    Liberar ();
+    m_indices.swap (indices);
+    m_almacen.swap (puntos);
+    m_nodos = m_indices.empty () ? 0 : m_indices.size () - 1;
+    m_inicio = m_indices.data ();
+    m_puntos = m_almacen.data ();
+}
+
+inline bool
+Trayectorias::EscribirCompilada (const std::string &archivo) const
+{
+    std::ofstream os (archivo.c_str (), std::ios::binary);
+    if (!os)
+    {
+        return false;
+    }
+    Cabecera cabecera;
+    std::memcpy (cabecera.magia, "TESISTRY", 8);
+    cabecera.version = 1;
+    cabecera.nodos = m_nodos;
+    cabecera.puntos = GetNPuntos ();
+    os.write (reinterpret_cast<const char *> (&cabecera), sizeof (cabecera));
+
+    uint64_t cero = 0;
+    const uint64_t *inicio = m_nodos > 0 ? m_inicio : &cero;
+    os.write (reinterpret_cast<const char *> (inicio), (uint64_t (m_nodos) + 1) * sizeof (uint64_t));
+    os.write (reinterpret_cast<const char *> (m_puntos), cabecera.puntos * sizeof (Punto));
+    return bool (os);
+}
+
+inline uint32_t
+Trayectorias::GetNNodos () const
+{
+    return m_nodos;
+}
+
+inline uint64_t
+Trayectorias::GetNPuntos () const
+{
+    return m_nodos > 0 ? m_inicio[m_nodos] : 0;
+}
+
+inline bool
+Trayectorias::Tiene (uint32_t nodo) const
+{
+    return nodo < m_nodos && m_inicio[nodo + 1] > m_inicio[nodo];
+}
+
+inline Recorrido
+Trayectorias::Get (uint32_t nodo) const
+{
+    return Recorrido (m_puntos + m_inicio[nodo], m_puntos + m_inicio[nodo + 1]);
+}
+
+inline Punto
+Trayectorias::Posicion (uint32_t nodo, double t) const
+{
+    if (!Tiene (nodo))
+    {
+        Punto origen = { t, 0.0, 0.0 };
+        return origen;
+    }
+    Recorrido puntos = Get (nodo);
+    Punto p = { t, puntos.back ().x, puntos.back ().y };
+    if (t <= puntos.front ().t)
+    {
+        p.x = puntos.front ().x;
+        p.y = puntos.front ().y;
+        return p;
+    }
+    const Punto *b = std::upper_bound (puntos.begin (), puntos.end (), t,
+                                       [] (double v, const Punto &q) { return v < q.t; });
+    if (b == puntos.end ())
+    {
+        return p;
+    }
+    const Punto &a = *(b - 1);
+    double f = (t - a.t) / (b->t - a.t);
+    p.x = a.x + f * (b->x - a.x);
+    p.y = a.y + f * (b->y - a.y);
+    return p;
+}
+
+inline void
+Trayectorias::Agregar (std::vector<Punto> &puntos, double t, double x, double y)
+{
+    // Dos puntos en el mismo instante: el ultimo manda
+    if (!puntos.empty () && puntos.back ().t == t)
+    {
+        puntos.back ().x = x;
+        puntos.back ().y = y;
+        return;
+    }
+    Punto p = { t, x, y };
+    puntos.push_back (p);
+}
+
+inline void
+Trayectorias::Construir (double x0, double y0, const std::vector<Destino> &destinos,
+                         std::vector<Punto> &puntos)
+{
+    Agregar (puntos, 0.0, x0, y0);
+
+    for (const Destino &d : destinos)
+    {
+        Punto &ultimo = puntos.back ();
+        if (d.t < ultimo.t && puntos.size () > 1)
+        {
+            // Nuevo destino antes de llegar: el tramo se corta en d.t
+            const Punto &a = puntos[puntos.size () - 2];
+            double f = (d.t - a.t) / (ultimo.t - a.t);
+            ultimo.t = d.t;
+            ultimo.x = a.x + f * (ultimo.x - a.x);
+            ultimo.y = a.y + f * (ultimo.y - a.y);
+        }
+        else
+        {
+            // Detenido hasta d.t
+            Agregar (puntos, d.t, ultimo.x, ultimo.y);
+        }
+
+        const Punto &actual = puntos.back ();
+        double distancia = std::sqrt ((d.x - actual.x) * (d.x - actual.x) +
+                                      (d.y - actual.y) * (d.y - actual.y));
+        if (d.velocidad > 0 && distancia > 0)
+        {
+            Agregar (puntos, d.t + distancia / d.velocidad, d.x, d.y);
+        }
+    }
+}
+
+} // namespace tesis
+
+#endif /* TESIS_TRAYECTORIAS_H */
@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TESIS_ZONA_PEDIDO_H
+#define TESIS_ZONA_PEDIDO_H
+
+#include "tabla-rutas6.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+namespace tesis {
+
+// Rectangulo al que se limita el reenvio de un RREQ; viaja en el RREQ
+struct ZonaPedido
+{
+    double x0;
+    double y0;
+    double x1;
+    double y1;
+
+    // Sin limite: inundacion completa
+    static ZonaPedido Completa ();
+
+    bool EsCompleta () const { return x0 == -std::numeric_limits<double>::infinity (); }
+    bool Contiene (double x, double y) const { return x0 <= x && x <= x1 && y0 <= y && y <= y1; }
+};
+
+inline ZonaPedido
+ZonaPedido::Completa ()
+{
+    double infinito = std::numeric_limits<double>::infinity ();
+    ZonaPedido z = { -infinito, -infinito, infinito, infinito };
+    return z;
+}
+
+// Ultima posicion conocida de un nodo
+struct Ubicacion
+{
+    double t;
+    double x;
+    double y;
+    // Velocidad con que acotar cuanto se movio desde t, m/s
+    double velocidad;
+};
+
+/*
+ * Zonas de pedido de Location-Aided Routing (esquema 1 de Ko y Vaidya)
+ * para el RREQ de un originador.
+ *
+ * El originador guarda la ultima ubicacion de cada destino, que le llega
+ * en los RREP (posicion y velocidad del MobilityModel del destino al
+ * contestar) y en los RREQ que el destino origina. Al buscarlo, el destino
+ * esta en el circulo de la ultima posicion con radio velocidad x el tiempo
+ * transcurrido mas margen; la zona de pedido es el menor rectangulo que
+ * contiene ese circulo y al originador. Solo reenvian el RREQ los nodos
+ * dentro de la zona (el destino contesta aunque este fuera).
+ *
+ * Sin ubicacion conocida la zona es Completa. Si el RREQ no consigue RREP,
+ * el reintento del port (RreqRetries) sale sin zona, asi que lo peor que
+ * pasa es un NetTraversalTime mas que la inundacion completa.
+ *
+ * El port toma como velocidad la mayor entre la del RREP y LarMinSpeed:
+ * un nodo en pausa (RandomWaypoint) contesta con velocidad 0. Los tiempos
+ * son segundos de simulacion y los nodos, identificadores de Internador6.
+ */
+class UbicacionesLar
+{
+public:
+    // margen: LarMargin, m
+    explicit UbicacionesLar (double margen = 0.0);
+
+    // Ubicacion de nodo recibida en un RREP o RREQ, si es mas nueva que la
+    // que se tenia
+    void Actualizar (uint32_t nodo, const Ubicacion &ubicacion);
+
+    void Olvidar (uint32_t nodo) { m_ubicaciones.Borrar (nodo); }
+
+    // Zona para buscar destino desde (x, y) en ahora
+    ZonaPedido Zona (uint32_t destino, double x, double y, double ahora) const;
+
+    uint32_t size () const { return m_ubicaciones.size (); }
+
+private:
+    double m_margen;
+    TablaRutas6<Ubicacion, uint32_t> m_ubicaciones;
+};
+
+inline
+UbicacionesLar::UbicacionesLar (double margen)
+  : m_margen (margen)
+{
+}
+
+inline void
+UbicacionesLar::Actualizar (uint32_t nodo, const Ubicacion &ubicacion)
+{
+    Ubicacion *u = m_ubicaciones.Buscar (nodo);
+    if (u == 0)
+    {
+        m_ubicaciones.Agregar (nodo, ubicacion);
+    }
+    else if (u->t <= ubicacion.t)
+    {
+        *u = ubicacion;
+    }
+}
+
+inline ZonaPedido
+UbicacionesLar::Zona (uint32_t destino, double x, double y, double ahora) const
+{
+    const Ubicacion *u = m_ubicaciones.Buscar (destino);
+    if (u == 0)
+    {
+        return ZonaPedido::Completa ();
+    }
+    double radio = u->velocidad * std::max (0.0, ahora - u->t) + m_margen;
+    ZonaPedido z = { std::min (x, u->x - radio), std::min (y, u->y - radio),
+                     std::max (x, u->x + radio), std::max (y, u->y + radio) };
+    return z;
+}
+
+} // namespace tesis
+
+#endif /* TESIS_ZONA_PEDIDO_H */
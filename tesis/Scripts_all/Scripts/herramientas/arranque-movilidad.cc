@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * Costo de arranque de la movilidad de los scripts AODV.
+ *
+ * Compara la instalacion anterior (Random Waypoint en todos los nodos y
+ * despues Ns2MobilityHelper sobre los mismos nodos) con FuenteMovilidad
+ * (un solo modelo por nodo). Para cada una mide el tiempo de instalacion,
+ * cuantos modelos de movilidad quedan agregados y cuantos eventos ejecuta
+ * el simulador en los primeros --tiempo segundos sin red ni trafico, es
+ * decir, solo los de movilidad. Se compila como los scripts (scratch):
+ *
+ *   ./waf --run "arranque-movilidad --traceFile=Escenarios/udptcp300.ns_movements --numNodos=300"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+
+#include "../comun/fuente-movilidad.h"
+#include "../comun/perfil.h"
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+using namespace ns3;
+
+struct Medicion
+{
+    double instalacion;
+    uint32_t modelos;
+    uint64_t eventos;
+};
+
+// Modelos de movilidad agregados a los nodos
+static uint32_t
+ContarModelos (NodeContainer nodos)
+{
+    uint32_t modelos = 0;
+    for (NodeContainer::Iterator i = nodos.Begin (); i != nodos.End (); ++i)
+    {
+        Object::AggregateIterator it = (*i)->GetAggregateIterator ();
+        while (it.HasNext ())
+        {
+            modelos += it.Next ()->GetInstanceTypeId ().IsChildOf (MobilityModel::GetTypeId ());
+        }
+    }
+    return modelos;
+}
+
+// Eventos ejecutados hasta el instante tiempo
+static uint64_t
+Eventos (double tiempo)
+{
+    ObjectFactory planificador;
+    planificador.SetTypeId (tesis::PlanificadorPerfil::GetTypeId ());
+    Simulator::SetScheduler (planificador);
+    Simulator::Stop (Seconds (tiempo));
+    Simulator::Run ();
+
+    uint64_t eventos = 0;
+    for (const tesis::PlanificadorPerfil::Tipo &t : tesis::PlanificadorPerfil::Actual ()->GetTipos ())
+    {
+        eventos += t.eventos;
+    }
+    Simulator::Destroy ();
+    return eventos;
+}
+
+static Medicion
+Anterior (const std::string &traza, uint32_t numNodos, double tiempo)
+{
+    NodeContainer nodos;
+    nodos.Create (numNodos);
+
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now ();
+    ObjectFactory of;
+    of.SetTypeId ("ns3::RandomRectanglePositionAllocator");
+    of.Set ("X", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=150.0]"));
+    of.Set ("Y", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=150.0]"));
+    Ptr<PositionAllocator> pa = of.Create ()->GetObject<PositionAllocator> ();
+
+    MobilityHelper mobility;
+    mobility.SetMobilityModel ("ns3::RandomWaypointMobilityModel",
+                               "Speed", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=20.0]"),
+                               "Pause", StringValue ("ns3::ConstantRandomVariable[Constant=0.0]"),
+                               "PositionAllocator", PointerValue (pa));
+    mobility.Install (nodos);
+
+    Ns2MobilityHelper ns2 = Ns2MobilityHelper (traza);
+    ns2.Install ();
+
+    Medicion m;
+    m.instalacion = std::chrono::duration<double> (std::chrono::steady_clock::now () - inicio).count ();
+    m.modelos = ContarModelos (nodos);
+    m.eventos = Eventos (tiempo);
+    return m;
+}
+
+static Medicion
+Fuente (const std::string &traza, const std::string &tipo, uint32_t numNodos, double tiempo)
+{
+    NodeContainer nodos;
+    nodos.Create (numNodos);
+
+    // La lectura de la traza cuenta como parte de la instalacion
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now ();
+    tesis::FuenteMovilidad movilidad;
+    movilidad.SetTipo (tipo);
+    movilidad.SetTraza (traza);
+    if (!movilidad.Preparar ())
+    {
+        NS_FATAL_ERROR ("No se pudo leer la traza " << traza);
+    }
+    movilidad.Instalar (nodos);
+
+    Medicion m;
+    m.instalacion = std::chrono::duration<double> (std::chrono::steady_clock::now () - inicio).count ();
+    m.modelos = ContarModelos (nodos);
+    m.eventos = Eventos (tiempo);
+    return m;
+}
+
+static void
+Imprimir (const std::string &nombre, const Medicion &m)
+{
+    std::cout << nombre << ": " << m.instalacion * 1e3 << " ms de instalacion, "
+              << m.modelos << " modelos, " << m.eventos << " eventos\n";
+}
+
+int
+main (int argc, char *argv[])
+{
+    std::string traceFile = "Escenarios/udptcp300.ns_movements";
+    uint32_t numNodos = 300;
+    double tiempo = 150.0;
+
+    CommandLine cmd;
+    cmd.AddValue ("traceFile", "Traza ns-2 (o compilada para la fuente nueva).", traceFile);
+    cmd.AddValue ("numNodos", "Numero de nodos.", numNodos);
+    cmd.AddValue ("tiempo", "Tiempo simulado para contar eventos, s.", tiempo);
+    cmd.Parse (argc, argv);
+
+    // Ns2MobilityHelper solo lee texto
+    std::string texto = traceFile;
+    std::string::size_type punto = texto.rfind (".tray");
+    if (punto != std::string::npos)
+    {
+        texto = texto.substr (0, punto) + ".ns_movements";
+    }
+
+    Imprimir ("Random Waypoint + Ns2MobilityHelper", Anterior (texto, numNodos, tiempo));
+    Imprimir ("FuenteMovilidad traza", Fuente (traceFile, "traza", numNodos, tiempo));
+    Imprimir ("FuenteMovilidad aleatoria", Fuente (traceFile, "aleatoria", numNodos, tiempo));
+    Imprimir ("FuenteMovilidad cuadricula", Fuente (traceFile, "cuadricula", numNodos, tiempo));
+    return 0;
+}
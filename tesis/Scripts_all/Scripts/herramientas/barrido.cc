@@ -0,0 +1,832 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * Barrido de parametros para los scripts AODV (IPv4/IPv6, UDP/TCP).
+ *
+ * Ejecuta la matriz script x numero de nodos x semilla como un conjunto de
+ * procesos en paralelo (uno por nucleo por defecto). Los trabajos mas
+ * costosos (300 nodos) se lanzan primero para que el pool no quede con un
+ * solo proceso largo al final.
+ *
+ * Los scripts deben estar compilados; se ejecutan directamente desde el
+ * directorio de binarios de ns-3, por lo que el barrido se lanza dentro de
+ * "./waf shell":
+ *
+ *   ./waf shell
+ *   barrido --bin=build/scratch --nodos=100,150,200,300 --semillas=1,2,3
+ *
+ * Todo lo que va despues de "--" se pasa tal cual a cada simulacion, por
+ * ejemplo atributos "--ns3::WifiPhy::TxPowerStart=16".
+ *
+ * Cada punto escribe en <salida>/<script>/<nodos>/semilla-<n>/ su
+ * flowMonNodes.xml y la salida estandar en salida.log.
+ *
+ * Si en --escenarios existe udptcp<N>.tray (compilada con
+ * compilar-trayectorias) los scripts la reciben en lugar de la traza de
+ * texto. Los escenarios grandes (1000 a 10000 nodos) solo traen el .params
+ * de BonnMotion y los scripts IPv6 lo generan al arrancar.
+ *
+ * Los resultados terminados se guardan en una cache por contenido
+ * (--cache=DIR, vacio para desactivarla). La clave es una huella de toda la
+ * configuracion del punto: script, nodos, tiempo, contenido de la traza de
+ * movilidad, semilla, pcap y los argumentos extra (atributos wifi/AODV),
+ * mas el contenido del binario del script y el tamano y la fecha de las
+ * bibliotecas de ns-3 en <bin>/../lib, para que una recompilacion invalide
+ * los resultados viejos. Un punto repetido se copia desde la cache sin
+ * simular.
+ *
+ * Con --precision=P el numero de replicas de cada punto (script x nodos) se
+ * decide sobre la marcha: se agregan semillas hasta que los intervalos de
+ * confianza del 95% de PDR, retardo medio y throughput tienen un semiancho
+ * menor que P veces la media, entre --replicasMin y --replicasMax. El
+ * resumen por punto queda en <salida>/resumen.txt. Las metricas se toman
+ * solo de los flujos de la aplicacion (estadistica.h), sin el control de
+ * AODV ni los ACK de TCP.
+ */
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "estadistica.h"
+#include "utilidades.h"
+
+// Script de simulacion y nombres de sus parametros de linea de comandos
+struct Variante
+{
+    const char *script;
+    const char *argNodos;
+    const char *argTiempo;
+    const char *argDirectorio;
+    // Puerto del servidor del primer flujo; el resto usa los siguientes
+    uint16_t puerto;
+};
+
+static const Variante variantes[] =
+{
+    { "aodv-ipv6",     "numNodos", "tiempoTotal", "directorio", 576 },
+    { "aodv-ipv6_TCP", "numNodos", "tiempoTotal", "directorio", 8080 },
+    { "aodv",          "size",     "time",        "outDir",     9 },
+    { "aodvTCP",       "size",     "time",        "outDir",     5050 },
+};
+
+// Un punto de la matriz (script x nodos) y sus replicas
+struct Punto
+{
+    const Variante *variante;
+    uint32_t nodos;
+    std::vector<uint32_t> semillas;
+    uint32_t pendientes;
+    std::vector<Metricas> metricas;
+    bool convergido;
+};
+
+// Una simulacion: un punto con una semilla
+struct Trabajo
+{
+    Punto *punto;
+    uint64_t orden;
+    const Variante *variante;
+    uint32_t nodos;
+    double tiempo;
+    uint32_t semilla;
+    std::string directorio;
+    double costo;
+    std::string huella;
+    std::string clave;
+};
+
+// Configuracion del barrido
+struct Opciones
+{
+    std::string bin;
+    std::string escenarios;
+    std::string salida;
+    std::vector<std::string> scripts;
+    std::vector<uint32_t> nodos;
+    std::vector<uint32_t> semillas;
+    double tiempo;
+    uint32_t procesos;
+    bool pcap;
+    std::string cache;
+    double precision;
+    uint32_t replicasMin;
+    uint32_t replicasMax;
+    std::vector<std::string> extra;
+};
+
+static const Variante *
+BuscarVariante (const std::string &script)
+{
+    for (const Variante &v : variantes)
+    {
+        if (script == v.script)
+        {
+            return &v;
+        }
+    }
+    return 0;
+}
+
+static void
+Uso ()
+{
+    std::cout <<
+        "Uso: barrido [opciones] [-- argumentos para las simulaciones]\n"
+        "  --bin=DIR         Directorio con los scripts compilados (build/scratch)\n"
+        "  --scripts=LISTA   aodv-ipv6,aodv-ipv6_TCP,aodv,aodvTCP\n"
+        "  --nodos=LISTA     Numeros de nodos, p.ej. 100,150,200,300\n"
+        "  --semillas=LISTA  Numeros de corrida (RngRun), p.ej. 1,2,3\n"
+        "  --tiempo=S        Tiempo de simulacion, s (150)\n"
+        "  --escenarios=DIR  Directorio con udptcp<N>.ns_movements (.tray o .params)\n"
+        "  --salida=DIR      Directorio raiz de resultados (barrido)\n"
+        "  --procesos=N      Procesos en paralelo (numero de nucleos)\n"
+        "  --pcap=0|1        Escribir trazas PCAP (0)\n"
+        "  --cache=DIR       Cache de resultados, vacio para desactivar (cache)\n"
+        "  --precision=P     Semiancho relativo objetivo del IC 95%, 0 = fijo (0)\n"
+        "  --replicasMin=N   Replicas minimas por punto con --precision (3)\n"
+        "  --replicasMax=N   Replicas maximas por punto con --precision (30)\n";
+}
+
+static bool
+LeerOpciones (int argc, char *argv[], Opciones &op)
+{
+    op.bin = "build/scratch";
+    op.escenarios = "Escenarios";
+    op.salida = "barrido";
+    op.scripts = Separar ("aodv-ipv6,aodv-ipv6_TCP,aodv,aodvTCP");
+    op.nodos = SepararEnteros ("100,150,200,300");
+    op.semillas = SepararEnteros ("1");
+    op.tiempo = 150.0;
+    op.procesos = std::max (1u, std::thread::hardware_concurrency ());
+    op.pcap = false;
+    op.cache = "cache";
+    op.precision = 0.0;
+    op.replicasMin = 3;
+    op.replicasMax = 30;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--")
+        {
+            op.extra.assign (argv + i + 1, argv + argc);
+            break;
+        }
+        std::string::size_type igual = arg.find ('=');
+        if (arg.compare (0, 2, "--") != 0 || igual == std::string::npos)
+        {
+            std::cerr << "Argumento no valido: " << arg << "\n";
+            return false;
+        }
+        std::string clave = arg.substr (2, igual - 2);
+        std::string valor = arg.substr (igual + 1);
+
+        if (clave == "bin") op.bin = valor;
+        else if (clave == "scripts") op.scripts = Separar (valor);
+        else if (clave == "nodos") op.nodos = SepararEnteros (valor);
+        else if (clave == "semillas") op.semillas = SepararEnteros (valor);
+        else if (clave == "tiempo") op.tiempo = std::atof (valor.c_str ());
+        else if (clave == "escenarios") op.escenarios = valor;
+        else if (clave == "salida") op.salida = valor;
+        else if (clave == "procesos") op.procesos = std::max (1, std::atoi (valor.c_str ()));
+        else if (clave == "pcap") op.pcap = valor == "1" || valor == "true";
+        else if (clave == "cache") op.cache = valor;
+        else if (clave == "precision") op.precision = std::atof (valor.c_str ());
+        else if (clave == "replicasMin") op.replicasMin = std::max (2, std::atoi (valor.c_str ()));
+        else if (clave == "replicasMax") op.replicasMax = std::max (1, std::atoi (valor.c_str ()));
+        else
+        {
+            std::cerr << "Opcion desconocida: " << clave << "\n";
+            return false;
+        }
+    }
+    return !op.scripts.empty () && !op.nodos.empty () && !op.semillas.empty ();
+}
+
+// FNV-1a de 64 bits
+static uint64_t
+Fnv (const char *datos, size_t n, uint64_t h = 14695981039346656037ULL)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        h ^= static_cast<unsigned char> (datos[i]);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static std::string
+Hex (uint64_t h)
+{
+    std::ostringstream os;
+    os << std::hex << std::setw (16) << std::setfill ('0') << h;
+    return os.str ();
+}
+
+// Huella del contenido de un archivo; cada traza se lee una sola vez
+static std::string
+HuellaArchivo (const std::string &ruta)
+{
+    static std::map<std::string, std::string> leidas;
+    std::map<std::string, std::string>::iterator it = leidas.find (ruta);
+    if (it != leidas.end ())
+    {
+        return it->second;
+    }
+
+    std::ifstream is (ruta.c_str (), std::ios::binary);
+    std::string huella = "ausente";
+    if (is)
+    {
+        uint64_t h = 14695981039346656037ULL;
+        char buf[1 << 16];
+        while (is.read (buf, sizeof (buf)) || is.gcount () > 0)
+        {
+            h = Fnv (buf, is.gcount (), h);
+        }
+        huella = Hex (h);
+    }
+    leidas[ruta] = huella;
+    return huella;
+}
+
+// Traza de movilidad del trabajo: la compilada si existe, si no la de
+// texto y si tampoco hay, el .params para generarla
+static std::string
+RutaTraza (const Opciones &op, const Trabajo &t)
+{
+    std::ostringstream base;
+    base << op.escenarios << "/udptcp" << t.nodos;
+    struct stat info;
+    if (stat ((base.str () + ".tray").c_str (), &info) == 0)
+    {
+        return base.str () + ".tray";
+    }
+    if (stat ((base.str () + ".ns_movements").c_str (), &info) != 0
+        && stat ((base.str () + ".params").c_str (), &info) == 0)
+    {
+        return base.str () + ".params";
+    }
+    return base.str () + ".ns_movements";
+}
+
+// Huella de las bibliotecas de ns-3 contra las que enlazan los scripts
+// (<bin>/../lib): un cambio en wifi o AODV recompila la biblioteca y no el
+// binario del script. Basta con nombre, tamano y fecha; se calcula una vez
+static std::string
+HuellaBibliotecas (const Opciones &op)
+{
+    static std::string huella;
+    if (!huella.empty ())
+    {
+        return huella;
+    }
+    std::string directorio = op.bin + "/../lib";
+    std::vector<std::string> lineas;
+    if (DIR *dir = opendir (directorio.c_str ()))
+    {
+        while (struct dirent *e = readdir (dir))
+        {
+            struct stat st;
+            std::string nombre = e->d_name;
+            if (nombre.compare (0, 6, "libns3") != 0
+                || stat ((directorio + "/" + nombre).c_str (), &st) != 0)
+            {
+                continue;
+            }
+            std::ostringstream os;
+            os << nombre << " " << st.st_size << " " << st.st_mtime;
+            lineas.push_back (os.str ());
+        }
+        closedir (dir);
+    }
+    std::sort (lineas.begin (), lineas.end ());
+    uint64_t h = Fnv ("", 0);
+    for (const std::string &l : lineas)
+    {
+        h = Fnv (l.c_str (), l.size () + 1, h);
+    }
+    huella = lineas.empty () ? "ausente" : Hex (h);
+    return huella;
+}
+
+// Descripcion canonica de todo lo que determina el resultado de un punto
+static std::string
+Huella (const Opciones &op, const Trabajo &t)
+{
+    std::ostringstream os;
+    os << "script=" << t.variante->script << "\n"
+       << "binario=" << HuellaArchivo (op.bin + "/" + t.variante->script) << "\n"
+       << "bibliotecas=" << HuellaBibliotecas (op) << "\n"
+       << "nodos=" << t.nodos << "\n"
+       << "tiempo=" << t.tiempo << "\n"
+       << "traza=" << HuellaArchivo (RutaTraza (op, t)) << "\n"
+       << "semilla=" << t.semilla << "\n"
+       << "pcap=" << op.pcap << "\n";
+    for (const std::string &e : op.extra)
+    {
+        os << "extra=" << e << "\n";
+    }
+    return os.str ();
+}
+
+static std::string
+DirectorioCache (const Opciones &op, const Trabajo &t)
+{
+    return op.cache + "/" + t.clave.substr (0, 2) + "/" + t.clave;
+}
+
+// Copia los archivos regulares de un directorio a otro (sin recursion)
+static bool
+CopiarArchivos (const std::string &origen, const std::string &destino)
+{
+    DIR *dir = opendir (origen.c_str ());
+    if (dir == 0 || !CrearDirectorio (destino))
+    {
+        if (dir != 0)
+        {
+            closedir (dir);
+        }
+        return false;
+    }
+
+    bool ok = true;
+    while (struct dirent *e = readdir (dir))
+    {
+        std::string desde = origen + "/" + e->d_name;
+        std::string hacia = destino + "/" + e->d_name;
+        struct stat st;
+        if (stat (desde.c_str (), &st) != 0 || !S_ISREG (st.st_mode))
+        {
+            continue;
+        }
+        std::ifstream is (desde.c_str (), std::ios::binary);
+        std::ofstream os (hacia.c_str (), std::ios::binary | std::ios::trunc);
+        // Copiar un archivo vacio con rdbuf marca error en os
+        if (st.st_size > 0)
+        {
+            os << is.rdbuf ();
+        }
+        ok = ok && is.good () && os.good ();
+    }
+    closedir (dir);
+    return ok;
+}
+
+// Borra un directorio con todo su contenido
+static void
+BorrarDirectorio (const std::string &ruta)
+{
+    if (DIR *dir = opendir (ruta.c_str ()))
+    {
+        while (struct dirent *e = readdir (dir))
+        {
+            std::string nombre = e->d_name;
+            if (nombre == "." || nombre == "..")
+            {
+                continue;
+            }
+            std::string hijo = ruta + "/" + nombre;
+            struct stat st;
+            if (lstat (hijo.c_str (), &st) == 0 && S_ISDIR (st.st_mode))
+            {
+                BorrarDirectorio (hijo);
+            }
+            else
+            {
+                unlink (hijo.c_str ());
+            }
+        }
+        closedir (dir);
+    }
+    rmdir (ruta.c_str ());
+}
+
+// Copia un resultado de la cache al directorio del punto si existe y la
+// huella guardada coincide
+static bool
+LeerCache (const Opciones &op, const Trabajo &t)
+{
+    if (op.cache.empty ())
+    {
+        return false;
+    }
+    std::string entrada = DirectorioCache (op, t);
+    std::ifstream is ((entrada + "/huella").c_str ());
+    std::stringstream guardada;
+    guardada << is.rdbuf ();
+    if (!is || guardada.str () != t.huella)
+    {
+        return false;
+    }
+    return CopiarArchivos (entrada + "/resultado", t.directorio);
+}
+
+// Guarda el resultado de un punto terminado; se escribe en un directorio
+// temporal y se publica con rename para no dejar entradas a medias
+static void
+GuardarCache (const Opciones &op, const Trabajo &t)
+{
+    if (op.cache.empty ())
+    {
+        return;
+    }
+    std::string entrada = DirectorioCache (op, t);
+    std::string temporal = entrada + ".tmp." + std::to_string (getpid ());
+    bool ok = CopiarArchivos (t.directorio, temporal + "/resultado");
+    if (ok)
+    {
+        std::ofstream huella ((temporal + "/huella").c_str ());
+        huella << t.huella;
+        huella.close ();
+        ok = bool (huella);
+    }
+    if (!ok || rename (temporal.c_str (), entrada.c_str ()) != 0)
+    {
+        std::cerr << "No se pudo guardar en cache " << entrada << "\n";
+        BorrarDirectorio (temporal);
+    }
+}
+
+// Cola de trabajos pendientes: primero los de mayor costo estimado. El
+// canal Yans entrega cada transmision a todos los nodos y el numero de
+// transmisiones crece con los nodos, asi que el costo se aproxima por
+// N^2 * tiempo. A igual costo se respeta el orden de llegada.
+struct MayorCosto
+{
+    bool operator() (const Trabajo *a, const Trabajo *b) const
+    {
+        if (a->costo != b->costo)
+        {
+            return a->costo < b->costo;
+        }
+        return a->orden > b->orden;
+    }
+};
+
+typedef std::vector<Trabajo *> Cola;
+
+static void
+NuevoTrabajo (const Opciones &op, Punto &p, uint32_t semilla,
+              std::deque<Trabajo> &trabajos, Cola &cola)
+{
+    std::ostringstream dir;
+    dir << op.salida << "/" << p.variante->script << "/" << p.nodos << "/semilla-" << semilla;
+
+    Trabajo t;
+    t.punto = &p;
+    t.orden = trabajos.size ();
+    t.variante = p.variante;
+    t.nodos = p.nodos;
+    t.tiempo = op.tiempo;
+    t.semilla = semilla;
+    t.directorio = dir.str ();
+    t.costo = double (p.nodos) * p.nodos * op.tiempo;
+    t.huella = Huella (op, t);
+    t.clave = Hex (Fnv (t.huella.data (), t.huella.size ()));
+    trabajos.push_back (t);
+
+    p.semillas.push_back (semilla);
+    ++p.pendientes;
+    cola.push_back (&trabajos.back ());
+    std::push_heap (cola.begin (), cola.end (), MayorCosto ());
+}
+
+// Puntos de la matriz con sus semillas iniciales
+static bool
+ArmarPuntos (const Opciones &op, std::deque<Punto> &puntos,
+             std::deque<Trabajo> &trabajos, Cola &cola)
+{
+    std::vector<uint32_t> semillas = op.semillas;
+    if (op.precision > 0)
+    {
+        // Con parada secuencial se arranca con al menos replicasMin semillas
+        uint32_t siguiente = *std::max_element (semillas.begin (), semillas.end ()) + 1;
+        while (semillas.size () < op.replicasMin)
+        {
+            semillas.push_back (siguiente++);
+        }
+    }
+
+    for (const std::string &script : op.scripts)
+    {
+        const Variante *variante = BuscarVariante (script);
+        if (variante == 0)
+        {
+            std::cerr << "Script desconocido: " << script << "\n";
+            return false;
+        }
+        for (uint32_t nodos : op.nodos)
+        {
+            Punto p;
+            p.variante = variante;
+            p.nodos = nodos;
+            p.pendientes = 0;
+            p.convergido = false;
+            puntos.push_back (p);
+            for (uint32_t semilla : semillas)
+            {
+                NuevoTrabajo (op, puntos.back (), semilla, trabajos, cola);
+            }
+        }
+    }
+    return true;
+}
+
+static Intervalo
+IntervaloMetrica (const Punto &p, double Metricas::*campo)
+{
+    std::vector<double> valores;
+    for (const Metricas &m : p.metricas)
+    {
+        valores.push_back (m.*campo);
+    }
+    return IntervaloConfianza (valores);
+}
+
+static bool
+Preciso (const Intervalo &ic, double precision)
+{
+    if (ic.n < 2)
+    {
+        return false;
+    }
+    if (ic.media == 0)
+    {
+        return ic.semiancho == 0;
+    }
+    return ic.semiancho <= precision * std::fabs (ic.media);
+}
+
+// Parada secuencial: decide si el punto necesita mas replicas y las agrega.
+// Mientras no converge se mantienen en vuelo tantas replicas del punto como
+// le tocan de los procesos libres entre los puntos activos.
+static void
+Decidir (const Opciones &op, Punto &p, size_t puntosActivos,
+         std::deque<Trabajo> &trabajos, Cola &cola)
+{
+    if (op.precision <= 0 || p.convergido)
+    {
+        return;
+    }
+    if (p.metricas.size () >= op.replicasMin &&
+        Preciso (IntervaloMetrica (p, &Metricas::pdr), op.precision) &&
+        Preciso (IntervaloMetrica (p, &Metricas::retardo), op.precision) &&
+        Preciso (IntervaloMetrica (p, &Metricas::throughput), op.precision))
+    {
+        p.convergido = true;
+        return;
+    }
+
+    uint32_t enVuelo = std::max<uint32_t> (1, op.procesos / std::max<size_t> (1, puntosActivos));
+    while (p.pendientes < enVuelo && p.semillas.size () < op.replicasMax)
+    {
+        uint32_t semilla = *std::max_element (p.semillas.begin (), p.semillas.end ()) + 1;
+        NuevoTrabajo (op, p, semilla, trabajos, cola);
+    }
+}
+
+static size_t
+PuntosActivos (const Opciones &op, const std::deque<Punto> &puntos)
+{
+    size_t activos = 0;
+    for (const Punto &p : puntos)
+    {
+        if (!p.convergido && (p.pendientes > 0 || p.semillas.size () < op.replicasMax))
+        {
+            ++activos;
+        }
+    }
+    return activos;
+}
+
+// Replicas y semiancho de los intervalos por punto, en pantalla y en
+// <salida>/resumen.txt
+static void
+Resumen (const Opciones &op, const std::deque<Punto> &puntos)
+{
+    std::ostringstream os;
+    os << "script\tnodos\treplicas\tconvergido\t"
+       << "pdr\tpdr_ic\tretardo_s\tretardo_ic\tthroughput_kbps\tthroughput_ic\n";
+    for (const Punto &p : puntos)
+    {
+        Intervalo pdr = IntervaloMetrica (p, &Metricas::pdr);
+        Intervalo retardo = IntervaloMetrica (p, &Metricas::retardo);
+        Intervalo throughput = IntervaloMetrica (p, &Metricas::throughput);
+        os << p.variante->script << "\t" << p.nodos << "\t" << p.metricas.size () << "\t"
+           << (op.precision > 0 ? (p.convergido ? "si" : "no") : "-") << "\t"
+           << pdr.media << "\t" << pdr.semiancho << "\t"
+           << retardo.media << "\t" << retardo.semiancho << "\t"
+           << throughput.media << "\t" << throughput.semiancho << "\n";
+    }
+
+    std::cout << "\n" << os.str ();
+    std::ofstream ((op.salida + "/resumen.txt").c_str ()) << os.str ();
+}
+
+static std::vector<std::string>
+Argumentos (const Opciones &op, const Trabajo &t)
+{
+    const Variante &v = *t.variante;
+    std::vector<std::string> args;
+    args.push_back (op.bin + "/" + v.script);
+    args.push_back (std::string ("--") + v.argNodos + "=" + std::to_string (t.nodos));
+    args.push_back (std::string ("--") + v.argTiempo + "=" + std::to_string (t.tiempo));
+    args.push_back (std::string ("--") + v.argDirectorio + "=" + t.directorio);
+    args.push_back ("--traceFile=" + RutaTraza (op, t));
+    args.push_back ("--RngRun=" + std::to_string (t.semilla));
+    args.push_back (std::string ("--pcap=") + (op.pcap ? "1" : "0"));
+    args.insert (args.end (), op.extra.begin (), op.extra.end ());
+    return args;
+}
+
+static pid_t
+Lanzar (const Opciones &op, const Trabajo &t)
+{
+    if (!CrearDirectorio (t.directorio))
+    {
+        std::cerr << "No se pudo crear " << t.directorio << "\n";
+        return -1;
+    }
+
+    std::vector<std::string> args = Argumentos (op, t);
+    pid_t pid = fork ();
+    if (pid != 0)
+    {
+        return pid;
+    }
+
+    // Proceso hijo: la salida de la simulacion va a su propio log
+    std::string log = t.directorio + "/salida.log";
+    int fd = open (log.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0)
+    {
+        dup2 (fd, STDOUT_FILENO);
+        dup2 (fd, STDERR_FILENO);
+        close (fd);
+    }
+    int nulo = open ("/dev/null", O_RDONLY);
+    if (nulo >= 0)
+    {
+        dup2 (nulo, STDIN_FILENO);
+        close (nulo);
+    }
+
+    std::vector<char *> argv;
+    for (std::string &a : args)
+    {
+        argv.push_back (&a[0]);
+    }
+    argv.push_back (0);
+    execv (argv[0], argv.data ());
+    std::perror (argv[0]);
+    _exit (127);
+}
+
+int
+main (int argc, char *argv[])
+{
+    Opciones op;
+    if (!LeerOpciones (argc, argv, op))
+    {
+        Uso ();
+        return 2;
+    }
+
+    // deque: los punteros a puntos y trabajos siguen validos al agregar
+    std::deque<Punto> puntos;
+    std::deque<Trabajo> trabajos;
+    Cola cola;
+    if (!ArmarPuntos (op, puntos, trabajos, cola) || !CrearDirectorio (op.salida))
+    {
+        return 2;
+    }
+
+    typedef std::chrono::steady_clock Reloj;
+    struct EnCurso
+    {
+        Trabajo *trabajo;
+        Reloj::time_point inicio;
+    };
+    std::map<pid_t, EnCurso> enCurso;
+    std::vector<const Trabajo *> fallidos;
+    size_t terminados = 0;
+    size_t enCache = 0;
+    Reloj::time_point inicio = Reloj::now ();
+
+    std::cout << "Barrido: " << trabajos.size () << " simulaciones iniciales en "
+              << op.procesos << " procesos\n";
+
+    // Registra el resultado de un trabajo terminado y decide si su punto
+    // necesita mas replicas
+    auto registrar = [&] (Trabajo &t, bool ok, const std::string &detalle)
+    {
+        ++terminados;
+        Punto &p = *t.punto;
+        --p.pendientes;
+        Metricas m;
+        if (ok && LeerFlowMonitor (t.directorio + "/flowMonNodes.xml", t.variante->puerto, m))
+        {
+            p.metricas.push_back (m);
+        }
+        else if (ok)
+        {
+            std::cerr << "Sin flowMonNodes.xml en " << t.directorio << "\n";
+        }
+        if (!ok)
+        {
+            fallidos.push_back (&t);
+        }
+        std::cout << "[" << terminados << "/" << trabajos.size () << "] "
+                  << t.variante->script << " nodos=" << t.nodos << " semilla=" << t.semilla
+                  << " " << detalle << "\n";
+        Decidir (op, p, PuntosActivos (op, puntos), trabajos, cola);
+    };
+
+    while (!cola.empty () || !enCurso.empty ())
+    {
+        while (!cola.empty () && enCurso.size () < op.procesos)
+        {
+            std::pop_heap (cola.begin (), cola.end (), MayorCosto ());
+            Trabajo &t = *cola.back ();
+            cola.pop_back ();
+            if (LeerCache (op, t))
+            {
+                ++enCache;
+                registrar (t, true, "cache");
+                continue;
+            }
+            pid_t pid = Lanzar (op, t);
+            if (pid < 0)
+            {
+                registrar (t, false, "FALLO al lanzar");
+                continue;
+            }
+            enCurso[pid] = EnCurso { &t, Reloj::now () };
+        }
+        if (enCurso.empty ())
+        {
+            continue;
+        }
+
+        int estado = 0;
+        pid_t pid = waitpid (-1, &estado, 0);
+        if (pid < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        std::map<pid_t, EnCurso>::iterator it = enCurso.find (pid);
+        if (it == enCurso.end ())
+        {
+            continue;
+        }
+
+        Trabajo &t = *it->second.trabajo;
+        double segundos = std::chrono::duration<double> (Reloj::now () - it->second.inicio).count ();
+        bool ok = WIFEXITED (estado) && WEXITSTATUS (estado) == 0;
+        enCurso.erase (it);
+        if (ok)
+        {
+            GuardarCache (op, t);
+        }
+        std::ostringstream detalle;
+        detalle << (ok ? "ok " : "FALLO ") << segundos << " s";
+        registrar (t, ok, detalle.str ());
+    }
+
+    double total = std::chrono::duration<double> (Reloj::now () - inicio).count ();
+    std::cout << "Barrido terminado en " << total << " s, "
+              << terminados << " simulaciones, "
+              << enCache << " desde cache, "
+              << fallidos.size () << " fallidos\n";
+    for (const Trabajo *t : fallidos)
+    {
+        std::cout << "  " << t->directorio << "/salida.log\n";
+    }
+    Resumen (op, puntos);
+    return fallidos.empty () ? 0 : 1;
+}
@@ -0,0 +1,215 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * Prueba de carga de tesis::CacheRreq frente a una copia del aodv::IdCache
+ * de ns-3 (vector de direccion, id y vencimiento; purga con remove_if y
+ * busqueda lineal en cada RREQ escuchado).
+ *
+ * Durante 10 s los nodos del escenario arrancan descubrimientos a la tasa
+ * indicada (por segundo, en toda la red), cada uno con un id nuevo de su
+ * originador. Cada oyente escucha cada inundacion: la primera copia tras
+ * 0-200 ms y de 0 a 7 copias mas de sus vecinos en los 50 ms siguientes;
+ * algunas llegan justo al vencer el registro (PathDiscoveryTime = 5.6 s)
+ * o un paso despues, para probar el borde. Como todos los oyentes ven lo
+ * mismo basta una muestra de ellos.
+ *
+ * Para cada tasa compara las respuestas de las dos caches: los falsos
+ * positivos (RREQ tomado por duplicado cuando IdCache ya lo habia
+ * olvidado) y los duplicados no detectados tienen que ser 0 sin desalojos
+ * y no superarlos con ellos. Da tambien las inundaciones simultaneas (las
+ * de una vida), la memoria de cada cache por nodo y el costo por RREQ.
+ *
+ *   cache-rreq [nodos] [oyentes] [capacidad] [tasa...]
+ *   cache-rreq 300 20 512 10 50 100 200 500
+ */
+
+#include "../comun/cache-rreq.h"
+#include "../comun/tabla-rutas6.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Pasos del simulador por segundo (Time en nanosegundos)
+static const int64_t SEGUNDO = 1000000000;
+static const int64_t VIDA = 5600000000LL;
+
+// Como aodv::IdCache, con la direccion IPv6 completa
+class IdCache
+{
+public:
+    bool IsDuplicate (const tesis::Direccion6 &origen, uint32_t id, int64_t ahora)
+    {
+        m_ids.erase (std::remove_if (m_ids.begin (), m_ids.end (),
+                                     [ahora] (const UniqueId &u) { return u.vencimiento < ahora; }),
+                     m_ids.end ());
+        for (const UniqueId &u : m_ids)
+        {
+            if (u.origen == origen && u.id == id)
+            {
+                return true;
+            }
+        }
+        UniqueId u = { origen, id, ahora + VIDA };
+        m_ids.push_back (u);
+        m_maximo = std::max<uint64_t> (m_maximo, m_ids.capacity () * sizeof (UniqueId));
+        return false;
+    }
+
+    // Mayor memoria reservada
+    uint64_t GetMaximo () const { return m_maximo; }
+
+private:
+    struct UniqueId
+    {
+        tesis::Direccion6 origen;
+        uint32_t id;
+        int64_t vencimiento;
+    };
+
+    std::vector<UniqueId> m_ids;
+    uint64_t m_maximo = 0;
+};
+
+// Un RREQ escuchado por un oyente
+struct Copia
+{
+    int64_t t;
+    uint32_t oyente;
+    uint32_t originador;
+    uint32_t id;
+};
+
+static tesis::Direccion6
+Direccion (uint32_t n)
+{
+    uint8_t b[16] = { 0x20, 0x01, 0, 0x01, 0, 0, 0, 0, 0x02, 0x00, 0x00, 0xff, 0xfe, 0, 0, 0 };
+    b[13] = (n + 1) >> 16;
+    b[14] = (n + 1) >> 8;
+    b[15] = n + 1;
+    return tesis::Direccion6::Desde (b);
+}
+
+static std::vector<Copia>
+Copias (uint32_t nodos, uint32_t oyentes, double tasa, uint64_t &inundaciones)
+{
+    std::mt19937_64 rng (11);
+    std::uniform_real_distribution<double> u (0.0, 1.0);
+    std::exponential_distribution<double> llegadas (tasa);
+    std::vector<uint32_t> ids (nodos, 0);
+    std::vector<Copia> copias;
+    inundaciones = 0;
+    for (double t = llegadas (rng); t < 10.0; t += llegadas (rng))
+    {
+        uint32_t originador = rng () % nodos;
+        uint32_t id = ++ids[originador];
+        ++inundaciones;
+        for (uint32_t o = 0; o < oyentes; ++o)
+        {
+            int64_t primera = int64_t ((t + 0.2 * u (rng)) * SEGUNDO);
+            Copia c = { primera, o, originador, id };
+            copias.push_back (c);
+            for (uint32_t k = rng () % 8; k > 0; --k)
+            {
+                c.t = primera + int64_t (0.05 * u (rng) * SEGUNDO);
+                copias.push_back (c);
+            }
+            if (u (rng) < 0.02)
+            {
+                c.t = primera + VIDA;
+                copias.push_back (c);
+                c.t = primera + VIDA + 1;
+                copias.push_back (c);
+            }
+        }
+    }
+    std::stable_sort (copias.begin (), copias.end (), [] (const Copia &a, const Copia &b) { return a.t < b.t; });
+    return copias;
+}
+
+template <typename F>
+static double
+Nanosegundos (uint64_t operaciones, F f)
+{
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now ();
+    f ();
+    return std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now () - inicio).count () / operaciones;
+}
+
+int
+main (int argc, char *argv[])
+{
+    uint32_t nodos = argc > 1 ? std::strtoul (argv[1], 0, 10) : 300;
+    uint32_t oyentes = argc > 2 ? std::strtoul (argv[2], 0, 10) : 20;
+    uint32_t capacidad = argc > 3 ? std::strtoul (argv[3], 0, 10) : 512;
+    std::vector<double> tasas;
+    for (int i = 4; i < argc; ++i)
+    {
+        tasas.push_back (std::strtod (argv[i], 0));
+    }
+    if (tasas.empty ())
+    {
+        tasas = { 10, 50, 100, 200, 500 };
+    }
+    if (nodos == 0 || oyentes == 0 || capacidad == 0)
+    {
+        std::cerr << "Uso: cache-rreq [nodos] [oyentes] [capacidad] [tasa...]\n";
+        return 2;
+    }
+
+    std::vector<tesis::Direccion6> direcciones;
+    for (uint32_t n = 0; n < nodos; ++n)
+    {
+        direcciones.push_back (Direccion (n));
+    }
+
+    bool bien = true;
+    std::cout << "tasa/s\tsimultaneas\tcopias\tfalsos_pos\tno_detectados\tdesalojos\t"
+              << "idcache_bytes\tcache_bytes\tidcache_ns\tcache_ns\n";
+    for (double tasa : tasas)
+    {
+        uint64_t inundaciones = 0;
+        std::vector<Copia> copias = Copias (nodos, oyentes, tasa, inundaciones);
+        std::vector<char> esperadas (copias.size ());
+        std::vector<char> obtenidas (copias.size ());
+
+        std::vector<IdCache> referencias (oyentes);
+        double nsReferencia = Nanosegundos (copias.size (), [&] ()
+        {
+            for (uint64_t i = 0; i < copias.size (); ++i)
+            {
+                const Copia &c = copias[i];
+                esperadas[i] = referencias[c.oyente].IsDuplicate (direcciones[c.originador], c.id, c.t);
+            }
+        });
+        std::vector<tesis::CacheRreq> caches (oyentes, tesis::CacheRreq (capacidad, VIDA));
+        double nsCache = Nanosegundos (copias.size (), [&] ()
+        {
+            for (uint64_t i = 0; i < copias.size (); ++i)
+            {
+                const Copia &c = copias[i];
+                obtenidas[i] = caches[c.oyente].EsDuplicado (c.originador, c.id, c.t);
+            }
+        });
+
+        uint64_t falsosPositivos = 0, noDetectados = 0, desalojos = 0, maximo = 0;
+        for (uint64_t i = 0; i < copias.size (); ++i)
+        {
+            falsosPositivos += obtenidas[i] && !esperadas[i];
+            noDetectados += !obtenidas[i] && esperadas[i];
+        }
+        for (uint32_t o = 0; o < oyentes; ++o)
+        {
+            desalojos += caches[o].GetDesalojos ();
+            maximo = std::max (maximo, referencias[o].GetMaximo ());
+        }
+        bien = bien && falsosPositivos <= desalojos && noDetectados <= desalojos;
+        std::cout << tasa << "\t" << inundaciones * VIDA / (10.0 * SEGUNDO) << "\t" << copias.size () << "\t"
+                  << falsosPositivos << "\t" << noDetectados << "\t" << desalojos << "\t" << maximo << "\t"
+                  << caches[0].GetMemoria () << "\t" << nsReferencia << "\t" << nsCache << "\n";
+    }
+    return bien ? 0 : 1;
+}
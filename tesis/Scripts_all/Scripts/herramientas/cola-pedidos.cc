@@ -0,0 +1,338 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * Compara tesis::ColaPedidos con una copia de la aodv::RequestQueue de
+ * ns-3 (vector que se purga con remove_if y se recorre por destino en cada
+ * Enqueue, Dequeue, DropPacketWithDst y GetSize).
+ *
+ * Primero las somete a la misma secuencia al azar de operaciones y exige
+ * los mismos resultados, los mismos paquetes entregados y los mismos
+ * descartes en el mismo orden. Despues mide el costo por operacion de un
+ * nodo que reenvia trafico de muchos flujos: paquetes para destinos al
+ * azar que esperan su ruta, un RREP cada tanto que entrega todos los de un
+ * destino y descubrimientos fallidos que los descartan.
+ *
+ *   cola-pedidos [destinos] [maximo...]
+ *   cola-pedidos 300 64 256 1024
+ */
+
+#include "../comun/cola-pedidos.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+static const int64_t SEGUNDO = 1000000000;
+static const int64_t ESPERA = 30 * SEGUNDO;
+
+// El paquete es su uid; descartar lo anota
+typedef uint64_t Paquete;
+
+// Como aodv::RequestQueue
+class RequestQueue
+{
+public:
+    RequestQueue (uint32_t maxLen, std::vector<Paquete> &descartes)
+      : m_maxLen (maxLen),
+        m_descartes (descartes)
+    {
+    }
+
+    bool Enqueue (uint32_t dst, Paquete p, int64_t now)
+    {
+        Purge (now);
+        for (const Entry &e : m_queue)
+        {
+            if (e.packet == p && e.dst == dst)
+            {
+                return false;
+            }
+        }
+        if (m_queue.size () == m_maxLen)
+        {
+            m_descartes.push_back (m_queue.front ().packet);
+            m_queue.erase (m_queue.begin ());
+        }
+        Entry e = { p, dst, now + ESPERA };
+        m_queue.push_back (e);
+        return true;
+    }
+
+    bool Dequeue (uint32_t dst, Paquete &p, int64_t now)
+    {
+        Purge (now);
+        for (std::vector<Entry>::iterator i = m_queue.begin (); i != m_queue.end (); ++i)
+        {
+            if (i->dst == dst)
+            {
+                p = i->packet;
+                m_queue.erase (i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void DropPacketWithDst (uint32_t dst, int64_t now)
+    {
+        Purge (now);
+        for (const Entry &e : m_queue)
+        {
+            if (e.dst == dst)
+            {
+                m_descartes.push_back (e.packet);
+            }
+        }
+        m_queue.erase (std::remove_if (m_queue.begin (), m_queue.end (),
+                                       [dst] (const Entry &e) { return e.dst == dst; }),
+                       m_queue.end ());
+    }
+
+    bool Find (uint32_t dst) const
+    {
+        for (const Entry &e : m_queue)
+        {
+            if (e.dst == dst)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint32_t GetSize (int64_t now)
+    {
+        Purge (now);
+        return m_queue.size ();
+    }
+
+private:
+    struct Entry
+    {
+        Paquete packet;
+        uint32_t dst;
+        int64_t expire;
+    };
+
+    void Purge (int64_t now)
+    {
+        for (const Entry &e : m_queue)
+        {
+            if (e.expire < now)
+            {
+                m_descartes.push_back (e.packet);
+            }
+        }
+        m_queue.erase (std::remove_if (m_queue.begin (), m_queue.end (),
+                                       [now] (const Entry &e) { return e.expire < now; }),
+                       m_queue.end ());
+    }
+
+    uint32_t m_maxLen;
+    std::vector<Entry> m_queue;
+    std::vector<Paquete> &m_descartes;
+};
+
+// Misma secuencia al azar en las dos colas
+static bool
+Comprobar (uint32_t destinos, uint32_t maximo)
+{
+    std::mt19937_64 rng (5);
+    std::vector<Paquete> descartesReferencia, descartesCola;
+    RequestQueue referencia (maximo, descartesReferencia);
+    tesis::EstadisticaColas estadistica;
+    tesis::ColaPedidos<Paquete> cola (maximo, ESPERA, &estadistica);
+    cola.SetDescartar ([&] (const Paquete &p) { descartesCola.push_back (p); });
+
+    int64_t ahora = 0;
+    Paquete siguiente = 1;
+    for (uint32_t i = 0; i < 300000; ++i)
+    {
+        // Pasos de hasta 2 s, a veces ninguno; algunos vencen justo en el borde
+        ahora += rng () % 4 == 0 ? 0 : rng () % (2 * SEGUNDO);
+        uint32_t d = rng () % destinos;
+        bool iguales = true;
+        switch (rng () % 8)
+        {
+        case 0:
+        case 1:
+        case 2:
+            {
+                // A veces el mismo paquete otra vez
+                Paquete p = rng () % 10 == 0 && siguiente > 1 ? siguiente - 1 - rng () % std::min<Paquete> (siguiente - 1, 5)
+                                                              : siguiente++;
+                iguales = referencia.Enqueue (d, p, ahora) == cola.Encolar (d, p, p, ahora);
+            }
+            break;
+        case 3:
+        case 4:
+            {
+                Paquete a = 0, b = 0;
+                iguales = referencia.Dequeue (d, a, ahora) == cola.Desencolar (d, b, ahora) && a == b;
+            }
+            break;
+        case 5:
+            referencia.DropPacketWithDst (d, ahora);
+            cola.DescartarDestino (d, ahora);
+            break;
+        case 6:
+            iguales = referencia.Find (d) == cola.Contiene (d);
+            break;
+        default:
+            iguales = referencia.GetSize (ahora) == cola.size (ahora);
+        }
+        if (!iguales || descartesReferencia != descartesCola)
+        {
+            std::cerr << "Difieren en la operacion " << i << "\n";
+            return false;
+        }
+        if (i % 100000 == 0)
+        {
+            // Que todo venza de una vez
+            ahora += ESPERA + 1;
+        }
+    }
+    std::cout << "maximo " << maximo << ": iguales; ";
+    estadistica.Reporte (std::cout);
+    return true;
+}
+
+template <typename F>
+static double
+Nanosegundos (uint64_t operaciones, F f)
+{
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now ();
+    f ();
+    return std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now () - inicio).count () / operaciones;
+}
+
+// Operacion de la carga: 0 encolar, 1 RREP (entregar todos los del
+// destino), 2 descubrimiento fallido, 3 GetSize
+struct Operacion
+{
+    int64_t t;
+    uint32_t destino;
+    uint32_t tipo;
+};
+
+static void
+Medir (uint32_t destinos, uint32_t maximo)
+{
+    std::mt19937_64 rng (9);
+    std::vector<Operacion> carga (1000000);
+    int64_t t = 0;
+    for (Operacion &o : carga)
+    {
+        t += rng () % (SEGUNDO / 1000);
+        uint32_t r = rng () % 100;
+        Operacion nueva = { t, uint32_t (rng () % destinos), r < 80 ? 0u : r < 95 ? 1u : r < 97 ? 2u : 3u };
+        o = nueva;
+    }
+
+    uint64_t suma = 0;
+    std::vector<Paquete> descartes;
+    RequestQueue referencia (maximo, descartes);
+    double nsReferencia = Nanosegundos (carga.size (), [&] ()
+    {
+        Paquete p = 0;
+        for (const Operacion &o : carga)
+        {
+            switch (o.tipo)
+            {
+            case 0:
+                referencia.Enqueue (o.destino, ++p, o.t);
+                break;
+            case 1:
+                for (Paquete q; referencia.Dequeue (o.destino, q, o.t); )
+                {
+                    suma += q;
+                }
+                break;
+            case 2:
+                referencia.DropPacketWithDst (o.destino, o.t);
+                break;
+            default:
+                suma += referencia.GetSize (o.t);
+            }
+            descartes.clear ();
+        }
+    });
+
+    tesis::EstadisticaColas estadistica;
+    tesis::ColaPedidos<Paquete> cola (maximo, ESPERA, &estadistica);
+    cola.SetDescartar ([&] (const Paquete &q) { suma += q; });
+    double nsCola = Nanosegundos (carga.size (), [&] ()
+    {
+        Paquete p = 0;
+        for (const Operacion &o : carga)
+        {
+            switch (o.tipo)
+            {
+            case 0:
+                ++p;
+                cola.Encolar (o.destino, p, p, o.t);
+                break;
+            case 1:
+                for (Paquete q; cola.Desencolar (o.destino, q, o.t); )
+                {
+                    suma += q;
+                }
+                break;
+            case 2:
+                cola.DescartarDestino (o.destino, o.t);
+                break;
+            default:
+                suma += cola.size (o.t);
+            }
+        }
+    });
+
+    std::cout << destinos << "\t" << maximo << "\t" << nsReferencia << "\t" << nsCola << "\t"
+              << nsReferencia / nsCola << "\t";
+    estadistica.Reporte (std::cout);
+    if (suma == 0)
+    {
+        std::cout << "\n";
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+    uint32_t destinos = argc > 1 ? std::strtoul (argv[1], 0, 10) : 300;
+    std::vector<uint32_t> maximos;
+    for (int i = 2; i < argc; ++i)
+    {
+        maximos.push_back (std::strtoul (argv[i], 0, 10));
+    }
+    if (maximos.empty ())
+    {
+        maximos = { 64, 256, 1024 };
+    }
+    if (destinos == 0)
+    {
+        std::cerr << "Uso: cola-pedidos [destinos] [maximo...]\n";
+        return 2;
+    }
+
+    // Con 8 lugares tambien se comparan los descartes por desborde
+    std::vector<uint32_t> comprobar (1, 8);
+    comprobar.insert (comprobar.end (), maximos.begin (), maximos.end ());
+    for (uint32_t maximo : comprobar)
+    {
+        if (!Comprobar (std::min<uint32_t> (destinos, 40), maximo))
+        {
+            return 1;
+        }
+    }
+
+    std::cout << "destinos\tmaximo\trequestqueue_ns\tcola_ns\tmejora\testadistica\n";
+    for (uint32_t maximo : maximos)
+    {
+        Medir (destinos, maximo);
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * Compila trazas de movimiento ns-2 (.ns_movements) al formato binario de
+ * tesis::Trayectorias (.tray), que los scripts IPv6 cargan con mmap sin
+ * interpretar texto:
+ *
+ *   compilar-trayectorias Escenarios/udptcp300.ns_movements Escenarios/udptcp300.tray
+ *
+ * Tambien acepta un .params de BonnMotion (RandomWaypoint): genera el
+ * escenario con tesis::GeneradorRwp en lugar de leer una traza.
+ *
+ * Sin archivo de salida se usa el de entrada con extension .tray.
+ */
+
+#include "../comun/escenario-rwp.h"
+#include "../comun/trayectorias.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+int
+main (int argc, char *argv[])
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "Uso: compilar-trayectorias entrada.ns_movements|entrada.params [salida.tray]\n";
+        return 2;
+    }
+    std::string entrada = argv[1];
+    std::string salida = argc == 3 ? argv[2] : entrada.substr (0, entrada.rfind ('.')) + ".tray";
+
+    tesis::Trayectorias trayectorias;
+    tesis::ParametrosRwp parametros;
+    if (entrada.size () > 7 && entrada.substr (entrada.size () - 7) == ".params")
+    {
+        if (!tesis::LeerParametrosRwp (entrada, parametros))
+        {
+            std::cerr << "No se pudo leer " << entrada << " o no es RandomWaypoint\n";
+            return 1;
+        }
+        std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now ();
+        tesis::GeneradorRwp (parametros).Generar (trayectorias);
+        double segundos = std::chrono::duration<double> (std::chrono::steady_clock::now () - inicio).count ();
+        std::cout << "Generados " << parametros.nodos << " nodos en " << segundos * 1e3 << " ms\n";
+    }
+    else if (!trayectorias.LeerNs2 (entrada))
+    {
+        std::cerr << "No se pudo leer " << entrada << "\n";
+        return 1;
+    }
+    if (!trayectorias.EscribirCompilada (salida))
+    {
+        std::cerr << "No se pudo escribir " << salida << "\n";
+        return 1;
+    }
+
+    // Comprobar que la salida se carga y medir cuanto tarda
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now ();
+    tesis::Trayectorias compilada;
+    if (!compilada.LeerCompilada (salida) || compilada.GetNPuntos () != trayectorias.GetNPuntos ())
+    {
+        std::cerr << "La salida " << salida << " no es valida\n";
+        return 1;
+    }
+    double segundos = std::chrono::duration<double> (std::chrono::steady_clock::now () - inicio).count ();
+
+    std::cout << salida << ": " << compilada.GetNNodos () << " nodos, "
+              << compilada.GetNPuntos () << " puntos de paso, carga en "
+              << segundos * 1e3 << " ms\n";
+    return 0;
+}
@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * Linea de tiempo de enlaces de un escenario: los intervalos exactos en que
+ * cada par de nodos esta dentro del radio de alcance (tesis::Enlaces), a
+ * partir de la traza de movimiento en texto, compilada o un .params:
+ *
+ *   enlaces Escenarios/udptcp300.tray 100 150 Escenarios/udptcp300-100m.enl
+ *
+ * Argumentos: traza, alcance en metros, duracion en segundos (0 = hasta el
+ * ultimo punto de paso), archivo de salida (por omision la traza con
+ * extension .enl) e hilos (0 = uno por nucleo). Con --comprobar ademas
+ * muestrea todos los pares cada 0.1 s y cuenta las diferencias con la
+ * linea de tiempo (fuera de una banda de 1 mm alrededor del alcance).
+ */
+
+#include "../comun/enlaces.h"
+#include "../comun/escenario-rwp.h"
+#include "../comun/trayectorias.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+static double
+Segundos (std::chrono::steady_clock::time_point desde)
+{
+    return std::chrono::duration<double> (std::chrono::steady_clock::now () - desde).count ();
+}
+
+// Diferencias entre la linea de tiempo y el muestreo de todos los pares
+static uint64_t
+Comprobar (const tesis::Trayectorias &trayectorias, const tesis::Enlaces &enlaces)
+{
+    uint64_t diferencias = 0;
+    uint32_t n = trayectorias.GetNNodos ();
+    double r = enlaces.GetAlcance ();
+    for (double t = 0.05; t < enlaces.GetDuracion (); t += 0.1)
+    {
+        for (uint32_t a = 0; a < n; ++a)
+        {
+            if (!trayectorias.Tiene (a))
+            {
+                continue;
+            }
+            tesis::Punto pa = trayectorias.Posicion (a, t);
+            for (uint32_t b = a + 1; b < n; ++b)
+            {
+                if (!trayectorias.Tiene (b))
+                {
+                    continue;
+                }
+                tesis::Punto pb = trayectorias.Posicion (b, t);
+                double d = std::sqrt ((pa.x - pb.x) * (pa.x - pb.x) + (pa.y - pb.y) * (pa.y - pb.y));
+                if (std::fabs (d - r) > 1e-3 && (d <= r) != enlaces.Conectados (a, b, t))
+                {
+                    ++diferencias;
+                }
+            }
+        }
+    }
+    return diferencias;
+}
+
+int
+main (int argc, char *argv[])
+{
+    bool comprobar = argc > 1 && std::string (argv[argc - 1]) == "--comprobar";
+    if (comprobar)
+    {
+        --argc;
+    }
+    if (argc < 4 || argc > 6)
+    {
+        std::cerr << "Uso: enlaces traza alcance duracion [salida.enl] [hilos] [--comprobar]\n";
+        return 2;
+    }
+    std::string entrada = argv[1];
+    double alcance = std::strtod (argv[2], 0);
+    double duracion = std::strtod (argv[3], 0);
+    std::string salida = argc > 4 ? argv[4] : entrada.substr (0, entrada.rfind ('.')) + ".enl";
+    uint32_t hilos = argc > 5 ? std::strtoul (argv[5], 0, 10) : 0;
+
+    tesis::Trayectorias trayectorias;
+    tesis::ParametrosRwp parametros;
+    if (entrada.size () > 7 && entrada.substr (entrada.size () - 7) == ".params")
+    {
+        if (!tesis::LeerParametrosRwp (entrada, parametros))
+        {
+            std::cerr << "No se pudo leer " << entrada << " o no es RandomWaypoint\n";
+            return 1;
+        }
+        tesis::GeneradorRwp (parametros).Generar (trayectorias, hilos);
+        if (duracion <= 0.0)
+        {
+            duracion = parametros.duracion;
+        }
+    }
+    else if (!trayectorias.Leer (entrada))
+    {
+        std::cerr << "No se pudo leer " << entrada << "\n";
+        return 1;
+    }
+
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now ();
+    tesis::Enlaces enlaces;
+    enlaces.Calcular (trayectorias, alcance, duracion, hilos);
+    double calculo = Segundos (inicio);
+    if (!enlaces.Escribir (salida))
+    {
+        std::cerr << "No se pudo escribir " << salida << "\n";
+        return 1;
+    }
+
+    uint64_t n = trayectorias.GetNNodos ();
+    std::cout << salida << ": " << enlaces.Get ().size () << " intervalos de enlace, "
+              << n << " nodos, alcance " << alcance << " m, " << enlaces.GetDuracion () << " s\n"
+              << "Calculo en " << calculo * 1e3 << " ms, " << enlaces.GetCandidatos ()
+              << " pares resueltos (" << n * (n - 1) / 2 << " pares en total por ventana)\n";
+
+    if (comprobar)
+    {
+        uint64_t diferencias = Comprobar (trayectorias, enlaces);
+        std::cout << "Muestreo cada 0.1 s: " << diferencias << " diferencias\n";
+        return diferencias == 0 ? 0 : 1;
+    }
+    return 0;
+}
@@ -0,0 +1,336 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * Banco de escala de los scripts AodvEjemplo (aodv-ipv6, aodv-ipv6_TCP).
+ *
+ * Corre el script una vez por tamano, de a uno para que las mediciones no
+ * se estorben, y registra tiempo real total y pico de memoria residente del
+ * proceso (getrusage de los hijos). Sirve para ver en que tamano deja de
+ * escalar:
+ *
+ *   ./waf shell
+ *   escala --bin=build/scratch --nodos=1000,2000,5000,10000 --flujos=10
+ *
+ * Los escenarios udptcp<N> se buscan en --escenarios como en el barrido:
+ * .tray, .ns_movements o el .params de BonnMotion, que el script genera al
+ * arrancar. Con --limite=S una corrida que pasa de S segundos se mata y
+ * queda como "limite" en la tabla.
+ *
+ * Las corridas medidas van sin perfil (--perfil=0): el perfil envuelve el
+ * planificador y mira cada transmision de la PHY, y eso infla el tiempo.
+ * Para la columna de eventos/s cada tamano corre una segunda vez con
+ * --perfil=1 solo para contar eventos; eventos/s es esa cuenta sobre el
+ * tiempo real de la corrida sin perfil. Con --eventos=0 se omite esa
+ * segunda corrida y la columna queda en 0.
+ *
+ * Cada tamano escribe en <salida>/<script>/<nodos>/ su salida.log y
+ * perfil.log, y la tabla queda en <salida>/escala.txt. Lo que va despues
+ * de "--" se pasa tal cual a cada corrida.
+ */
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utilidades.h"
+
+// Configuracion del banco
+struct Opciones
+{
+    std::string bin;
+    std::string script;
+    std::string escenarios;
+    std::string salida;
+    std::vector<uint32_t> nodos;
+    double tiempo;
+    uint32_t flujos;
+    double limite;
+    bool eventos;
+    std::vector<std::string> extra;
+};
+
+// Medicion de una corrida
+struct Medicion
+{
+    uint32_t nodos;
+    std::string estado;
+    double real;
+    double memoria;
+    uint64_t eventos;
+    double eventosPorSegundo;
+};
+
+static void
+Uso ()
+{
+    std::cout <<
+        "Uso: escala [opciones] [-- argumentos para las simulaciones]\n"
+        "  --bin=DIR         Directorio con los scripts compilados (build/scratch)\n"
+        "  --script=NOMBRE   aodv-ipv6 o aodv-ipv6_TCP (aodv-ipv6)\n"
+        "  --nodos=LISTA     Tamanos (1000,2000,5000,10000)\n"
+        "  --tiempo=S        Tiempo de simulacion, s (150)\n"
+        "  --flujos=N        Flujos cliente-servidor (10)\n"
+        "  --escenarios=DIR  Directorio con udptcp<N>.* (Escenarios)\n"
+        "  --salida=DIR      Directorio de resultados (escala)\n"
+        "  --limite=S        Tiempo real maximo por corrida, 0 = sin limite (0)\n"
+        "  --eventos=0|1     Correr otra vez con perfil para contar eventos (1)\n";
+}
+
+static bool
+LeerOpciones (int argc, char *argv[], Opciones &op)
+{
+    op.bin = "build/scratch";
+    op.script = "aodv-ipv6";
+    op.escenarios = "Escenarios";
+    op.salida = "escala";
+    op.nodos = SepararEnteros ("1000,2000,5000,10000");
+    op.tiempo = 150.0;
+    op.flujos = 10;
+    op.limite = 0.0;
+    op.eventos = true;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--")
+        {
+            op.extra.assign (argv + i + 1, argv + argc);
+            break;
+        }
+        std::string::size_type igual = arg.find ('=');
+        if (arg.compare (0, 2, "--") != 0 || igual == std::string::npos)
+        {
+            std::cerr << "Argumento no valido: " << arg << "\n";
+            return false;
+        }
+        std::string clave = arg.substr (2, igual - 2);
+        std::string valor = arg.substr (igual + 1);
+
+        if (clave == "bin") op.bin = valor;
+        else if (clave == "script") op.script = valor;
+        else if (clave == "nodos") op.nodos = SepararEnteros (valor);
+        else if (clave == "tiempo") op.tiempo = std::atof (valor.c_str ());
+        else if (clave == "flujos") op.flujos = std::max (1, std::atoi (valor.c_str ()));
+        else if (clave == "escenarios") op.escenarios = valor;
+        else if (clave == "salida") op.salida = valor;
+        else if (clave == "limite") op.limite = std::atof (valor.c_str ());
+        else if (clave == "eventos") op.eventos = valor == "1";
+        else
+        {
+            std::cerr << "Opcion desconocida: " << clave << "\n";
+            return false;
+        }
+    }
+    if (op.script != "aodv-ipv6" && op.script != "aodv-ipv6_TCP")
+    {
+        std::cerr << "Solo los scripts AodvEjemplo tienen --flujos: " << op.script << "\n";
+        return false;
+    }
+    return !op.nodos.empty ();
+}
+
+// Escenario del tamano: compilado, texto o parametros para generarlo
+static std::string
+RutaTraza (const Opciones &op, uint32_t nodos)
+{
+    std::ostringstream base;
+    base << op.escenarios << "/udptcp" << nodos;
+    const char *extensiones[] = { ".tray", ".ns_movements", ".params" };
+    struct stat info;
+    for (const char *e : extensiones)
+    {
+        if (stat ((base.str () + e).c_str (), &info) == 0)
+        {
+            return base.str () + e;
+        }
+    }
+    return base.str () + ".params";
+}
+
+// Eventos y eventos/s de la linea "Perfil: ..." del script
+static void
+LeerPerfil (const std::string &log, Medicion &m)
+{
+    std::ifstream is (log.c_str ());
+    std::string linea;
+    while (std::getline (is, linea))
+    {
+        unsigned long long eventos = 0;
+        double porSegundo = 0;
+        std::string::size_type coma = linea.find (" s reales, ");
+        if (linea.compare (0, 8, "Perfil: ") == 0 && coma != std::string::npos
+            && std::sscanf (linea.c_str (), "Perfil: %llu", &eventos) == 1
+            && std::sscanf (linea.c_str () + coma, " s reales, %lf", &porSegundo) == 1)
+        {
+            m.eventos = eventos;
+            m.eventosPorSegundo = porSegundo;
+        }
+    }
+}
+
+// Una corrida del script; con perfilar lee la cuenta de eventos del perfil
+static Medicion
+Correr (const Opciones &op, uint32_t nodos, bool perfilar)
+{
+    Medicion m;
+    m.nodos = nodos;
+    m.real = 0;
+    m.memoria = 0;
+    m.eventos = 0;
+    m.eventosPorSegundo = 0;
+
+    std::ostringstream dir;
+    dir << op.salida << "/" << op.script << "/" << nodos;
+    if (!CrearDirectorio (dir.str ()))
+    {
+        m.estado = "sin directorio";
+        return m;
+    }
+
+    std::vector<std::string> args;
+    args.push_back (op.bin + "/" + op.script);
+    args.push_back ("--numNodos=" + std::to_string (nodos));
+    args.push_back ("--tiempoTotal=" + std::to_string (op.tiempo));
+    args.push_back ("--directorio=" + dir.str ());
+    args.push_back ("--traceFile=" + RutaTraza (op, nodos));
+    args.push_back ("--flujos=" + std::to_string (op.flujos));
+    args.push_back ("--pcap=0");
+    args.push_back ("--imprimirRutas=0");
+    args.push_back (std::string ("--perfil=") + (perfilar ? "1" : "0"));
+    args.insert (args.end (), op.extra.begin (), op.extra.end ());
+
+    std::string log = dir.str () + (perfilar ? "/perfil.log" : "/salida.log");
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now ();
+    pid_t pid = fork ();
+    if (pid < 0)
+    {
+        m.estado = "fork fallo";
+        return m;
+    }
+    if (pid == 0)
+    {
+        int fd = open (log.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0)
+        {
+            dup2 (fd, STDOUT_FILENO);
+            dup2 (fd, STDERR_FILENO);
+            close (fd);
+        }
+        int nulo = open ("/dev/null", O_RDONLY);
+        if (nulo >= 0)
+        {
+            dup2 (nulo, STDIN_FILENO);
+            close (nulo);
+        }
+        std::vector<char *> argv;
+        for (std::string &a : args)
+        {
+            argv.push_back (&a[0]);
+        }
+        argv.push_back (0);
+        execv (argv[0], argv.data ());
+        std::perror (argv[0]);
+        _exit (127);
+    }
+
+    // Se espera sondeando para poder aplicar el limite de tiempo
+    int estado = 0;
+    struct rusage uso;
+    bool matado = false;
+    while (true)
+    {
+        pid_t r = wait4 (pid, &estado, WNOHANG, &uso);
+        if (r == pid)
+        {
+            break;
+        }
+        if (r < 0 && errno != EINTR)
+        {
+            m.estado = "wait4 fallo";
+            return m;
+        }
+        double transcurrido = std::chrono::duration<double> (std::chrono::steady_clock::now () - inicio).count ();
+        if (!matado && op.limite > 0 && transcurrido > op.limite)
+        {
+            kill (pid, SIGKILL);
+            matado = true;
+        }
+        std::this_thread::sleep_for (std::chrono::milliseconds (50));
+    }
+
+    m.real = std::chrono::duration<double> (std::chrono::steady_clock::now () - inicio).count ();
+    // ru_maxrss en KiB en Linux
+    m.memoria = uso.ru_maxrss / 1024.0;
+    if (matado)
+    {
+        m.estado = "limite";
+    }
+    else if (WIFEXITED (estado) && WEXITSTATUS (estado) == 0)
+    {
+        m.estado = "ok";
+        if (perfilar)
+        {
+            LeerPerfil (log, m);
+        }
+    }
+    else
+    {
+        m.estado = "fallo";
+    }
+    return m;
+}
+
+int
+main (int argc, char *argv[])
+{
+    Opciones op;
+    if (!LeerOpciones (argc, argv, op))
+    {
+        Uso ();
+        return 2;
+    }
+    if (!CrearDirectorio (op.salida))
+    {
+        std::cerr << "No se pudo crear " << op.salida << "\n";
+        return 2;
+    }
+
+    std::ostringstream tabla;
+    tabla << "script\tnodos\tflujos\testado\treal_s\tmemoria_mb\teventos\teventos_s\n";
+    bool ok = true;
+    for (uint32_t nodos : op.nodos)
+    {
+        std::cout << op.script << " nodos=" << nodos << " ... " << std::flush;
+        Medicion m = Correr (op, nodos, false);
+        if (op.eventos && m.estado == "ok")
+        {
+            Medicion perfilada = Correr (op, nodos, true);
+            m.eventos = perfilada.eventos;
+            m.eventosPorSegundo = m.real > 0 ? perfilada.eventos / m.real : 0.0;
+        }
+        std::cout << m.estado << " " << m.real << " s, " << m.memoria << " MB, "
+                  << m.eventosPorSegundo << " eventos/s\n";
+        tabla << op.script << "\t" << nodos << "\t" << op.flujos << "\t" << m.estado << "\t"
+              << m.real << "\t" << m.memoria << "\t" << m.eventos << "\t" << m.eventosPorSegundo << "\n";
+        ok = ok && m.estado == "ok";
+    }
+
+    std::cout << "\n" << tabla.str ();
+    std::ofstream ((op.salida + "/escala.txt").c_str ()) << tabla.str ();
+    return ok ? 0 : 1;
+}
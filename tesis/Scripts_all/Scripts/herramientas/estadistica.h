@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TESIS_ESTADISTICA_H
+#define TESIS_ESTADISTICA_H
+
+/*
+ * Metricas por replica leidas del flowMonNodes.xml que escribe Ejecutar()
+ * e intervalos de confianza del 95% entre replicas.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Metricas agregadas sobre los flujos de la aplicacion de una replica
+struct Metricas
+{
+    // Paquetes recibidos / enviados
+    double pdr;
+    // Retardo medio extremo a extremo (s), NaN si no se recibio nada
+    double retardo;
+    // Throughput recibido (kbit/s)
+    double throughput;
+};
+
+// Media y semiancho del intervalo de confianza del 95%
+struct Intervalo
+{
+    uint32_t n;
+    double media;
+    double semiancho;
+};
+
+// Valor numerico de un atributo XML; quita el "+" y la unidad "ns" que
+// FlowMonitor agrega a los tiempos
+inline double
+AtributoXml (const std::string &elemento, const std::string &nombre)
+{
+    std::string::size_type i = elemento.find (" " + nombre + "=\"");
+    if (i == std::string::npos)
+    {
+        return 0.0;
+    }
+    i += nombre.size () + 3;
+    return std::strtod (elemento.c_str () + i, 0);
+}
+
+// Puertos UDP de AODV (RFC 3561) y primero del rango efimero de ns-3, que
+// usan los clientes y el flujo inverso de ACK de TCP
+const uint16_t PUERTO_AODV = 654;
+const uint16_t PUERTO_EFIMERO = 49152;
+
+// Flujo de la aplicacion: su puerto de destino es el del servidor (puerto
+// del script + k para el flujo k), no el de AODV ni uno efimero
+inline bool
+PuertoAplicacion (double destino, uint16_t puerto)
+{
+    return destino >= puerto && destino < PUERTO_EFIMERO && destino != PUERTO_AODV;
+}
+
+// Metricas de los flujos de la aplicacion de un flowMonNodes.xml; puerto es
+// el primer puerto de servidor del script. Los flujos de control de AODV y
+// los de ACK de TCP se identifican en <Ipv4FlowClassifier> y
+// <Ipv6FlowClassifier> y no se suman
+inline bool
+LeerFlowMonitor (const std::string &archivo, uint16_t puerto, Metricas &m)
+{
+    std::ifstream is (archivo.c_str ());
+    if (!is)
+    {
+        return false;
+    }
+    std::stringstream contenido;
+    contenido << is.rdbuf ();
+    std::string xml = contenido.str ();
+
+    std::string::size_type fin = xml.find ("</FlowStats>");
+    if (fin == std::string::npos)
+    {
+        return false;
+    }
+
+    std::vector<bool> datos;
+    for (const char *seccion : { "<Ipv4FlowClassifier>", "<Ipv6FlowClassifier>" })
+    {
+        std::string::size_type inicio = xml.find (seccion);
+        std::string::size_type cierre = xml.find ("</", inicio);
+        for (std::string::size_type i = xml.find ("<Flow ", inicio); i < cierre; i = xml.find ("<Flow ", i + 1))
+        {
+            std::string flujo = xml.substr (i, xml.find ('>', i) - i);
+            if (PuertoAplicacion (AtributoXml (flujo, "destinationPort"), puerto))
+            {
+                uint32_t id = AtributoXml (flujo, "flowId");
+                datos.resize (std::max<size_t> (datos.size (), id + 1), false);
+                datos[id] = true;
+            }
+        }
+    }
+
+    double tx = 0, rx = 0, rxBytes = 0, retardo = 0;
+    double primerTx = std::numeric_limits<double>::max ();
+    double ultimoRx = 0;
+    for (std::string::size_type i = xml.find ("<Flow "); i < fin; i = xml.find ("<Flow ", i + 1))
+    {
+        std::string flujo = xml.substr (i, xml.find ('>', i) - i);
+        uint32_t id = AtributoXml (flujo, "flowId");
+        if (id >= datos.size () || !datos[id])
+        {
+            continue;
+        }
+        tx += AtributoXml (flujo, "txPackets");
+        rx += AtributoXml (flujo, "rxPackets");
+        rxBytes += AtributoXml (flujo, "rxBytes");
+        retardo += AtributoXml (flujo, "delaySum") * 1e-9;
+        primerTx = std::min (primerTx, AtributoXml (flujo, "timeFirstTxPacket") * 1e-9);
+        ultimoRx = std::max (ultimoRx, AtributoXml (flujo, "timeLastRxPacket") * 1e-9);
+    }
+
+    m.pdr = tx > 0 ? rx / tx : 0.0;
+    m.retardo = rx > 0 ? retardo / rx : std::numeric_limits<double>::quiet_NaN ();
+    m.throughput = ultimoRx > primerTx ? rxBytes * 8 / (ultimoRx - primerTx) / 1000 : 0.0;
+    return true;
+}
+
+// Cuantil 0.975 de la t de Student con gl grados de libertad
+inline double
+CuantilT (uint32_t gl)
+{
+    static const double tabla[] =
+    {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    if (gl == 0)
+    {
+        return std::numeric_limits<double>::infinity ();
+    }
+    if (gl <= 30)
+    {
+        return tabla[gl - 1];
+    }
+    return 1.960 + 2.5 / gl;
+}
+
+// Intervalo de confianza del 95% de la media; ignora valores NaN
+inline Intervalo
+IntervaloConfianza (const std::vector<double> &valores)
+{
+    Intervalo ic = { 0, 0.0, std::numeric_limits<double>::infinity () };
+    double suma = 0;
+    for (double v : valores)
+    {
+        if (!std::isnan (v))
+        {
+            suma += v;
+            ++ic.n;
+        }
+    }
+    if (ic.n == 0)
+    {
+        return ic;
+    }
+    ic.media = suma / ic.n;
+    if (ic.n < 2)
+    {
+        return ic;
+    }
+
+    double cuadrados = 0;
+    for (double v : valores)
+    {
+        if (!std::isnan (v))
+        {
+            cuadrados += (v - ic.media) * (v - ic.media);
+        }
+    }
+    double desvio = std::sqrt (cuadrados / (ic.n - 1));
+    ic.semiancho = CuantilT (ic.n - 1) * desvio / std::sqrt (double (ic.n));
+    return ic;
+}
+
+#endif /* TESIS_ESTADISTICA_H */
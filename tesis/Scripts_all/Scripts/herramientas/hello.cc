@@ -0,0 +1,353 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * HELLO fijo de ns-3 frente a tesis::HelloAdaptativo sobre la linea de
+ * tiempo exacta de enlaces de un escenario (tesis::Enlaces).
+ *
+ * Cada nodo anuncia con HELLOs segun su politica y con difusiones de
+ * control (RREQ, RERR) que llegan al azar; cada anuncio llega a los nodos
+ * que estan en alcance en ese instante salvo que se pierda (colision), y
+ * el receptor mantiene al emisor como vecino durante la vida anunciada.
+ * Un vecino nuevo o uno que vence es un cambio para la politica del
+ * receptor (VecinoNuevo, VecinoPerdido).
+ *
+ * Para cada politica da los HELLOs enviados y suprimidos, los bytes de
+ * control de HELLO (un RREP IPv6 de 44 bytes en UDP e IPv6, 92 bytes) y,
+ * como medida del efecto sobre la entrega, cuanto del tiempo en que un
+ * enlace existe el vecino lo desconoce, cuanto lo sigue creyendo despues
+ * de que cayo (rutas por enlaces rotos hasta que vence) y la demora media
+ * en notar una caida.
+ *
+ * La adaptativa se compara con la fija: bytes de control ahorrados y el
+ * cambio en la tasa de entrega (PDR) estimada. La estimacion supone que un
+ * paquete que sale por un vecino conocido se pierde si el enlace ya cayo,
+ * asi que cada salto entrega la fraccion del tiempo conocido en que el
+ * enlace existe, y una ruta de saltos saltos entrega esa fraccion a la
+ * saltos. No cuenta colisiones ni reparaciones de ruta; sirve para
+ * comparar politicas sobre la misma traza, no como PDR absoluto.
+ *
+ *   hello traza alcance duracion [maximo] [factor] [difusiones/s] [perdida] [saltos]
+ *   hello Escenarios/udptcp300.params 100 0 4 2 0.1 0.05 3
+ */
+
+#include "../comun/enlaces.h"
+#include "../comun/escenario-rwp.h"
+#include "../comun/hello-adaptativo.h"
+#include "../comun/trayectorias.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Bytes de un HELLO en IP: RREP IPv6 (44) + UDP (8) + IPv6 (40)
+static const uint32_t BYTES_HELLO = 92;
+
+// Intervalo de enlace visto desde un nodo
+struct Tramo
+{
+    uint32_t otro;
+    double desde;
+    double hasta;
+};
+
+struct Evento
+{
+    double t;
+    // 0 HELLO, 1 difusion, 2 vence un vecino
+    uint32_t tipo;
+    uint32_t nodo;
+    uint32_t otro;
+    uint64_t generacion;
+
+    bool operator> (const Evento &o) const { return t > o.t; }
+};
+
+// Vecino conocido por un nodo
+struct Vecino
+{
+    double desde;
+    double vence;
+    uint64_t generacion;
+};
+
+struct Resultado
+{
+    uint64_t enviados;
+    uint64_t suprimidos;
+    double arriba;
+    double desconocido;
+    double obsoleto;
+    uint64_t caidas;
+};
+
+typedef std::pair<double, double> Intervalo;
+
+// Tiempo comun de dos listas de intervalos ordenados y disjuntos
+static double
+Comun (const std::vector<Intervalo> &x, const std::vector<Intervalo> &y)
+{
+    double total = 0.0;
+    size_t i = 0, j = 0;
+    while (i < x.size () && j < y.size ())
+    {
+        double desde = std::max (x[i].first, y[j].first);
+        double hasta = std::min (x[i].second, y[j].second);
+        if (hasta > desde)
+        {
+            total += hasta - desde;
+        }
+        (x[i].second < y[j].second ? i : j)++;
+    }
+    return total;
+}
+
+static uint64_t
+Par (uint32_t receptor, uint32_t emisor)
+{
+    return (uint64_t (receptor) << 32) | emisor;
+}
+
+static Resultado
+Simular (const tesis::Enlaces &enlaces, const tesis::ParametrosHello &parametros, double difusiones,
+         double perdida)
+{
+    uint32_t n = enlaces.GetNNodos ();
+    double fin = enlaces.GetDuracion ();
+    std::vector<std::vector<Tramo> > tramos (n);
+    for (const tesis::Enlace &e : enlaces.Get ())
+    {
+        Tramo ab = { e.b, e.desde, e.hasta };
+        Tramo ba = { e.a, e.desde, e.hasta };
+        tramos[e.a].push_back (ab);
+        tramos[e.b].push_back (ba);
+    }
+
+    std::mt19937_64 rng (13);
+    std::uniform_real_distribution<double> u (0.0, 1.0);
+    std::exponential_distribution<double> llegadas (difusiones > 0 ? difusiones : 1.0);
+
+    std::vector<tesis::HelloAdaptativo> politicas (n, tesis::HelloAdaptativo (parametros));
+    std::vector<uint64_t> generacionHello (n, 0);
+    // Una sola cuenta para los vecinos: uno que vence y vuelve no reusa
+    // generaciones de eventos viejos
+    uint64_t generacionVecinos = 0;
+    std::vector<std::unordered_map<uint32_t, Vecino> > tablas (n);
+    // Intervalos en que cada receptor conoce a cada emisor
+    std::unordered_map<uint64_t, std::vector<Intervalo> > conocidos;
+    std::priority_queue<Evento, std::vector<Evento>, std::greater<Evento> > eventos;
+
+    auto programarHello = [&] (uint32_t nodo)
+    {
+        Evento e = { politicas[nodo].GetProximo (), 0, nodo, 0, ++generacionHello[nodo] };
+        eventos.push (e);
+    };
+    auto perdido = [&] (uint32_t nodo, double t)
+    {
+        double antes = politicas[nodo].GetProximo ();
+        politicas[nodo].VecinoPerdido (t);
+        if (politicas[nodo].GetProximo () < antes)
+        {
+            programarHello (nodo);
+        }
+    };
+    auto anunciar = [&] (uint32_t emisor, double t)
+    {
+        double vida = politicas[emisor].GetVida ();
+        for (const Tramo &tr : tramos[emisor])
+        {
+            if (tr.desde > t || tr.hasta <= t || u (rng) < perdida)
+            {
+                continue;
+            }
+            bool nuevo = tablas[tr.otro].count (emisor) == 0;
+            Vecino &v = tablas[tr.otro][emisor];
+            if (nuevo)
+            {
+                v.desde = t;
+            }
+            v.vence = t + vida;
+            v.generacion = ++generacionVecinos;
+            Evento e = { v.vence, 2, tr.otro, emisor, v.generacion };
+            eventos.push (e);
+            if (nuevo)
+            {
+                politicas[tr.otro].VecinoNuevo ();
+            }
+        }
+    };
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        politicas[i].Iniciar (0.0, u (rng) * parametros.minimo);
+        programarHello (i);
+        if (difusiones > 0)
+        {
+            Evento e = { llegadas (rng), 1, i, 0, 0 };
+            eventos.push (e);
+        }
+    }
+
+    Resultado r = Resultado ();
+    while (!eventos.empty () && eventos.top ().t < fin)
+    {
+        Evento e = eventos.top ();
+        eventos.pop ();
+        if (e.tipo == 0)
+        {
+            if (e.generacion != generacionHello[e.nodo])
+            {
+                continue;
+            }
+            if (politicas[e.nodo].Vencer (e.t))
+            {
+                anunciar (e.nodo, e.t);
+            }
+            programarHello (e.nodo);
+        }
+        else if (e.tipo == 1)
+        {
+            politicas[e.nodo].Difusion (e.t);
+            anunciar (e.nodo, e.t);
+            e.t += llegadas (rng);
+            eventos.push (e);
+        }
+        else
+        {
+            std::unordered_map<uint32_t, Vecino>::iterator v = tablas[e.nodo].find (e.otro);
+            if (v == tablas[e.nodo].end () || v->second.generacion != e.generacion)
+            {
+                continue;
+            }
+            conocidos[Par (e.nodo, e.otro)].push_back (Intervalo (v->second.desde, v->second.vence));
+            tablas[e.nodo].erase (v);
+            perdido (e.nodo, e.t);
+        }
+    }
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        r.enviados += politicas[i].GetEnviados ();
+        r.suprimidos += politicas[i].GetSuprimidos ();
+        for (const auto &v : tablas[i])
+        {
+            conocidos[Par (i, v.first)].push_back (Intervalo (v.second.desde, std::min (v.second.vence, fin)));
+        }
+    }
+
+    // Cada enlace, visto desde los dos extremos
+    std::unordered_map<uint64_t, std::vector<Intervalo> > arriba;
+    for (const tesis::Enlace &e : enlaces.Get ())
+    {
+        arriba[Par (e.a, e.b)].push_back (Intervalo (e.desde, e.hasta));
+        arriba[Par (e.b, e.a)].push_back (Intervalo (e.desde, e.hasta));
+        r.caidas += 2 * (e.hasta < fin);
+    }
+    for (const auto &p : arriba)
+    {
+        const std::vector<Intervalo> &k = conocidos[p.first];
+        double total = 0.0, conocido = 0.0;
+        for (const Intervalo &i : p.second)
+        {
+            total += i.second - i.first;
+        }
+        for (const Intervalo &i : k)
+        {
+            conocido += i.second - i.first;
+        }
+        double comun = Comun (p.second, k);
+        r.arriba += total;
+        r.desconocido += total - comun;
+        r.obsoleto += conocido - comun;
+    }
+    return r;
+}
+
+// Fraccion del tiempo en que se conoce a un vecino con el enlace arriba
+static double
+EntregaPorSalto (const Resultado &r)
+{
+    double comun = r.arriba - r.desconocido;
+    return comun + r.obsoleto > 0 ? comun / (comun + r.obsoleto) : 1.0;
+}
+
+static void
+Imprimir (const char *nombre, const Resultado &r, const Resultado &base, double fin, uint32_t saltos)
+{
+    double entrega = std::pow (EntregaPorSalto (r), saltos);
+    std::cout << nombre << ": " << r.enviados << " HELLOs (" << r.suprimidos << " suprimidos), "
+              << r.enviados * BYTES_HELLO << " bytes de control, " << r.enviados * BYTES_HELLO / fin
+              << " bytes/s";
+    std::cout << "\n    enlace desconocido " << 100.0 * r.desconocido / r.arriba << "% del tiempo arriba, "
+              << "vecino obsoleto " << 100.0 * r.obsoleto / r.arriba << "%, caida notada en "
+              << (r.caidas > 0 ? r.obsoleto / r.caidas : 0.0) << " s de media"
+              << "\n    PDR estimada " << 100.0 * entrega << "% con rutas de " << saltos << " saltos\n";
+    if (&r != &base)
+    {
+        double entregaBase = std::pow (EntregaPorSalto (base), saltos);
+        int64_t ahorrados = int64_t (base.enviados) - int64_t (r.enviados);
+        std::cout << "    frente al fijo: " << ahorrados * int64_t (BYTES_HELLO) << " bytes de control ahorrados ("
+                  << 100.0 * ahorrados / base.enviados << "%), PDR "
+                  << (entrega >= entregaBase ? "+" : "") << 100.0 * (entrega - entregaBase) << " puntos\n";
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+    if (argc < 4 || argc > 9)
+    {
+        std::cerr << "Uso: hello traza alcance duracion [maximo] [factor] [difusiones/s] [perdida] [saltos]\n";
+        return 2;
+    }
+    std::string entrada = argv[1];
+    double alcance = std::strtod (argv[2], 0);
+    double duracion = std::strtod (argv[3], 0);
+    tesis::ParametrosHello adaptativo = tesis::ParametrosHello::Fijo ();
+    adaptativo.maximo = argc > 4 ? std::strtod (argv[4], 0) : 4.0;
+    adaptativo.factor = argc > 5 ? std::strtod (argv[5], 0) : 2.0;
+    double difusiones = argc > 6 ? std::strtod (argv[6], 0) : 0.1;
+    double perdida = argc > 7 ? std::strtod (argv[7], 0) : 0.05;
+    uint32_t saltos = argc > 8 ? std::strtoul (argv[8], 0, 10) : 3;
+    if (saltos == 0)
+    {
+        std::cerr << "Se necesita al menos un salto\n";
+        return 2;
+    }
+
+    tesis::Trayectorias trayectorias;
+    tesis::ParametrosRwp parametros;
+    if (entrada.size () > 7 && entrada.substr (entrada.size () - 7) == ".params")
+    {
+        if (!tesis::LeerParametrosRwp (entrada, parametros))
+        {
+            std::cerr << "No se pudo leer " << entrada << " o no es RandomWaypoint\n";
+            return 1;
+        }
+        tesis::GeneradorRwp (parametros).Generar (trayectorias);
+        if (duracion <= 0.0)
+        {
+            duracion = parametros.duracion;
+        }
+    }
+    else if (!trayectorias.Leer (entrada))
+    {
+        std::cerr << "No se pudo leer " << entrada << "\n";
+        return 1;
+    }
+    tesis::Enlaces enlaces;
+    enlaces.Calcular (trayectorias, alcance, duracion);
+
+    std::cout << entrada << ": " << enlaces.GetNNodos () << " nodos, " << enlaces.Get ().size ()
+              << " intervalos de enlace, " << enlaces.GetDuracion () << " s, " << difusiones
+              << " difusiones/s por nodo, " << 100.0 * perdida << "% de anuncios perdidos\n";
+    Resultado fijo = Simular (enlaces, tesis::ParametrosHello::Fijo (), difusiones, perdida);
+    Resultado variable = Simular (enlaces, adaptativo, difusiones, perdida);
+    Imprimir ("Fijo (ns-3, 1 s)", fijo, fijo, enlaces.GetDuracion (), saltos);
+    std::cout << "Adaptativo (" << adaptativo.minimo << "-" << adaptativo.maximo << " s, x" << adaptativo.factor << ")";
+    Imprimir ("", variable, fijo, enlaces.GetDuracion (), saltos);
+    return 0;
+}
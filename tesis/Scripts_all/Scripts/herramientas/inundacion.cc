@@ -0,0 +1,476 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * Inundacion ciega de RREQ frente a los modos probabilistico y por
+ * contador de tesis::ReenvioRreq y a la zona de pedido de
+ * tesis::UbicacionesLar, sobre la topologia de un escenario
+ * (tesis::Enlaces).
+ *
+ * Cada descubrimiento toma un instante, un originador y un destino al azar
+ * y simula la inundacion de un RREQ sobre los enlaces de ese instante con
+ * un MAC 802.11b de difusion: trama de 124 bytes (RREQ IPv6 de 48 + UDP +
+ * IPv6 + MAC) a 1 Mb/s con preambulo largo, deteccion de portadora en el
+ * alcance, DIFS y backoff de 0 a 31 ranuras, sin ACK ni reintentos. Una
+ * recepcion se pierde si se superpone con otra (terminal oculto) o si el
+ * receptor transmite; el reenvio sale tras el jitter de 0-10 ms de AODV o,
+ * con CONTADOR, tras su espera. El destino no reenvia y contesta con un
+ * RREP unicast por el camino inverso (el nodo del que cada uno escucho
+ * primero el RREQ), que compite por el medio con lo que queda de la
+ * inundacion y se reintenta hasta 7 veces por salto. Si no vuelve, el
+ * originador repite el RREQ sin zona despues de NetTraversalTime (2.8 s),
+ * sobre la misma topologia. No hay respuestas de nodos intermedios ni
+ * anillo expansivo.
+ *
+ * Con zona, el originador conoce la posicion del destino de hasta
+ * antiguedad segundos antes y lo acota con la mayor velocidad de la traza;
+ * solo reenvian los nodos dentro del rectangulo (mas margen metros, por
+ * omision el alcance).
+ *
+ * Para cada modo da las transmisiones y bytes de RREQ por descubrimiento,
+ * las recepciones perdidas por colision, la cobertura del primer RREQ
+ * (nodos alcanzados sobre los conectados al originador), los reintentos,
+ * las rutas obtenidas (RREP de vuelta en el originador) sobre los destinos
+ * conectados y la latencia media del descubrimiento hasta ese RREP.
+ *
+ *   inundacion traza alcance [descubrimientos] [probabilidad] [umbral] [espera_ms] [saltos_ciegos]
+ *              [antiguedad_s] [margen_m]
+ *   inundacion Escenarios/udptcp300.ns_movements 100 200 0.5 3 50 0
+ *   inundacion Escenarios/udptcp5000.params 50 50 0.5 3 50 0 20 50
+ */
+
+#include "../comun/enlaces.h"
+#include "../comun/escenario-rwp.h"
+#include "../comun/reenvio-rreq.h"
+#include "../comun/trayectorias.h"
+#include "../comun/zona-pedido.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+static const int64_t MICRO = 1000;
+static const int64_t SEGUNDO = 1000000 * MICRO;
+// 124 bytes a 1 Mb/s mas 192 us de preambulo y cabecera PLCP
+static const int64_t TRAMA = (124 * 8 + 192) * MICRO;
+static const uint32_t BYTES_RREQ = 124;
+static const int64_t DIFS = 50 * MICRO;
+static const int64_t RANURA = 20 * MICRO;
+static const uint32_t VENTANA = 32;
+// Jitter de las difusiones de AODV
+static const int64_t JITTER = 10000 * MICRO;
+// Espera del originador antes de repetir el RREQ (2 x 40 ms x 35 saltos)
+static const double NET_TRAVERSAL = 2.8;
+// Reintentos de una trama unicast (dot11ShortRetryLimit)
+static const uint32_t REINTENTOS = 7;
+static const uint32_t NINGUNO = 0xffffffff;
+
+struct Evento
+{
+    int64_t t;
+    // 0 trama a la cola del nodo, 1 fin del backoff, 2 fin de la trama,
+    // 3 fin de la espera de CONTADOR
+    uint32_t tipo;
+    uint32_t nodo;
+    // Con 0, la trama: RREQ o RREP
+    uint32_t trama;
+
+    bool operator> (const Evento &o) const { return t > o.t; }
+};
+
+enum Trama
+{
+    RREQ,
+    RREP
+};
+
+struct Resultado
+{
+    uint64_t descubrimientos;
+    uint64_t transmisiones;
+    uint64_t perdidas;
+    uint64_t alcanzados;
+    uint64_t conectados;
+    uint64_t reintentos;
+    uint64_t destinosConectados;
+    uint64_t rutas;
+    double latencia;
+};
+
+// Nodos conectados a origen, contandolo
+static uint32_t
+Componente (const std::vector<std::vector<uint32_t> > &vecinos, uint32_t origen, std::vector<char> &marcado)
+{
+    marcado.assign (vecinos.size (), 0);
+    std::vector<uint32_t> pila (1, origen);
+    marcado[origen] = 1;
+    uint32_t total = 0;
+    while (!pila.empty ())
+    {
+        uint32_t n = pila.back ();
+        pila.pop_back ();
+        ++total;
+        for (uint32_t v : vecinos[n])
+        {
+            if (!marcado[v])
+            {
+                marcado[v] = 1;
+                pila.push_back (v);
+            }
+        }
+    }
+    return total;
+}
+
+// Un RREQ y su RREP; devuelve cuando llego el RREP al originador, s, o -1
+static double
+Inundar (const std::vector<std::vector<uint32_t> > &vecinos, const std::vector<tesis::Punto> &posiciones,
+         uint32_t origen, uint32_t destino, const tesis::ParametrosReenvio &parametros,
+         const tesis::ZonaPedido &zona, std::mt19937_64 &rng, Resultado &r)
+{
+    double llegada = -1.0;
+    uint32_t n = vecinos.size ();
+    std::uniform_real_distribution<double> u (0.0, 1.0);
+    std::vector<tesis::ReenvioRreq> politicas (n, tesis::ReenvioRreq (parametros));
+    std::vector<char> recibido (n, 0), transmitiendo (n, 0), limpio (n, 0), esperando (n, 0), accediendo (n, 0);
+    std::vector<uint32_t> saltos (n, 0), activos (n, 0), emisor (n, NINGUNO), padre (n, NINGUNO), intentos (n, 0);
+    std::vector<std::deque<uint32_t> > colas (n);
+    std::priority_queue<Evento, std::vector<Evento>, std::greater<Evento> > eventos;
+
+    auto backoff = [&] (uint32_t nodo, int64_t t)
+    {
+        Evento e = { t + DIFS + int64_t (rng () % VENTANA) * RANURA, 1, nodo, 0 };
+        eventos.push (e);
+    };
+    // Pide el medio para la primera trama de la cola
+    auto acceder = [&] (uint32_t nodo, int64_t t)
+    {
+        accediendo[nodo] = 1;
+        if (activos[nodo] > 0 || transmitiendo[nodo])
+        {
+            // Se retoma cuando el medio queda libre
+            esperando[nodo] = 1;
+        }
+        else
+        {
+            backoff (nodo, t);
+        }
+    };
+
+    recibido[origen] = 1;
+    Evento inicio = { 0, 0, origen, RREQ };
+    eventos.push (inicio);
+    while (!eventos.empty ())
+    {
+        Evento e = eventos.top ();
+        eventos.pop ();
+        uint32_t nodo = e.nodo;
+        if (e.tipo == 0)
+        {
+            colas[nodo].push_back (e.trama);
+            if (!accediendo[nodo])
+            {
+                acceder (nodo, e.t);
+            }
+        }
+        else if (e.tipo == 1)
+        {
+            if (activos[nodo] > 0)
+            {
+                esperando[nodo] = 1;
+                continue;
+            }
+            transmitiendo[nodo] = 1;
+            limpio[nodo] = 0;
+            r.transmisiones += colas[nodo].front () == RREQ;
+            for (uint32_t v : vecinos[nodo])
+            {
+                if (activos[v]++ == 0)
+                {
+                    emisor[v] = nodo;
+                    limpio[v] = !transmitiendo[v];
+                }
+                else
+                {
+                    limpio[v] = 0;
+                }
+            }
+            Evento fin = { e.t + TRAMA, 2, nodo, 0 };
+            eventos.push (fin);
+        }
+        else if (e.tipo == 2)
+        {
+            transmitiendo[nodo] = 0;
+            uint32_t trama = colas[nodo].front ();
+            bool entregada = trama == RREQ;
+            for (uint32_t v : vecinos[nodo])
+            {
+                bool recibida = emisor[v] == nodo && limpio[v];
+                if (--activos[v] == 0)
+                {
+                    emisor[v] = NINGUNO;
+                    if (esperando[v])
+                    {
+                        esperando[v] = 0;
+                        backoff (v, e.t);
+                    }
+                }
+                if (trama == RREP)
+                {
+                    if (v == padre[nodo] && recibida)
+                    {
+                        entregada = true;
+                        if (v == origen)
+                        {
+                            llegada = double (e.t) / SEGUNDO;
+                        }
+                        else
+                        {
+                            Evento rrep = { e.t, 0, v, RREP };
+                            eventos.push (rrep);
+                        }
+                    }
+                    continue;
+                }
+                if (!recibida)
+                {
+                    ++r.perdidas;
+                    continue;
+                }
+                if (recibido[v])
+                {
+                    politicas[v].Duplicada (origen, 1);
+                    continue;
+                }
+                recibido[v] = 1;
+                saltos[v] = saltos[nodo] + 1;
+                padre[v] = nodo;
+                ++r.alcanzados;
+                if (v == destino)
+                {
+                    Evento rrep = { e.t, 0, v, RREP };
+                    eventos.push (rrep);
+                    continue;
+                }
+                if (!zona.Contiene (posiciones[v].x, posiciones[v].y))
+                {
+                    continue;
+                }
+                int64_t espera = 0;
+                double azar = u (rng);
+                switch (politicas[v].Primera (origen, 1, saltos[v], azar, espera))
+                {
+                case tesis::ReenvioRreq::REENVIAR:
+                    {
+                        Evento pedido = { e.t + int64_t (u (rng) * JITTER), 0, v, RREQ };
+                        eventos.push (pedido);
+                    }
+                    break;
+                case tesis::ReenvioRreq::ESPERAR:
+                    {
+                        Evento evaluar = { e.t + espera, 3, v, 0 };
+                        eventos.push (evaluar);
+                    }
+                    break;
+                default:
+                    break;
+                }
+            }
+            // El RREP unicast se reintenta hasta REINTENTOS veces
+            if (entregada || ++intentos[nodo] > REINTENTOS)
+            {
+                colas[nodo].pop_front ();
+                intentos[nodo] = 0;
+            }
+            accediendo[nodo] = 0;
+            if (!colas[nodo].empty ())
+            {
+                acceder (nodo, e.t);
+            }
+        }
+        else if (politicas[nodo].Evaluar (origen, 1))
+        {
+            Evento pedido = { e.t, 0, nodo, RREQ };
+            eventos.push (pedido);
+        }
+    }
+    return llegada;
+}
+
+static void
+Imprimir (const char *nombre, const Resultado &r)
+{
+    double d = r.descubrimientos;
+    std::cout << nombre << "\t" << r.transmisiones / d << "\t" << r.transmisiones * BYTES_RREQ / d << "\t"
+              << r.perdidas / d << "\t" << 100.0 * (r.alcanzados + r.descubrimientos) / r.conectados << "\t" << r.reintentos << "\t"
+              << 100.0 * r.rutas / r.destinosConectados << "\t"
+              << (r.rutas > 0 ? 1000.0 * r.latencia / r.rutas : 0.0) << "\n";
+}
+
+// Modo a comparar: politica de reenvio y si usa zona de pedido
+struct Modo
+{
+    std::string nombre;
+    tesis::ParametrosReenvio parametros;
+    bool zona;
+};
+
+int
+main (int argc, char *argv[])
+{
+    if (argc < 3 || argc > 10)
+    {
+        std::cerr << "Uso: inundacion traza alcance [descubrimientos] [probabilidad] [umbral] [espera_ms] "
+                  << "[saltos_ciegos] [antiguedad_s] [margen_m]\n";
+        return 2;
+    }
+    std::string entrada = argv[1];
+    double alcance = std::strtod (argv[2], 0);
+    uint32_t descubrimientos = argc > 3 ? std::strtoul (argv[3], 0, 10) : 200;
+    tesis::ParametrosReenvio probabilistico = tesis::ParametrosReenvio::Ciego ();
+    probabilistico.modo = tesis::ParametrosReenvio::PROBABILISTICO;
+    probabilistico.probabilidad = argc > 4 ? std::strtod (argv[4], 0) : 0.5;
+    tesis::ParametrosReenvio contador = tesis::ParametrosReenvio::Ciego ();
+    contador.modo = tesis::ParametrosReenvio::CONTADOR;
+    contador.umbral = argc > 5 ? std::strtoul (argv[5], 0, 10) : 3;
+    contador.espera = int64_t ((argc > 6 ? std::strtod (argv[6], 0) : 50.0) * 1000 * MICRO);
+    probabilistico.saltosCiegos = contador.saltosCiegos = argc > 7 ? std::strtoul (argv[7], 0, 10) : 0;
+    double antiguedad = argc > 8 ? std::strtod (argv[8], 0) : 20.0;
+    double margen = argc > 9 ? std::strtod (argv[9], 0) : alcance;
+
+    tesis::Trayectorias trayectorias;
+    tesis::ParametrosRwp rwp = tesis::ParametrosRwp ();
+    double duracion = 0.0;
+    if (entrada.size () > 7 && entrada.substr (entrada.size () - 7) == ".params")
+    {
+        if (!tesis::LeerParametrosRwp (entrada, rwp))
+        {
+            std::cerr << "No se pudo leer " << entrada << " o no es RandomWaypoint\n";
+            return 1;
+        }
+        tesis::GeneradorRwp (rwp).Generar (trayectorias);
+        duracion = rwp.duracion;
+    }
+    else if (!trayectorias.Leer (entrada))
+    {
+        std::cerr << "No se pudo leer " << entrada << "\n";
+        return 1;
+    }
+    tesis::Enlaces enlaces;
+    // Sin duracion: hasta el ultimo punto de paso
+    enlaces.Calcular (trayectorias, alcance, duracion);
+    uint32_t n = enlaces.GetNNodos ();
+    if (n < 2)
+    {
+        std::cerr << "La traza necesita al menos dos nodos\n";
+        return 1;
+    }
+
+    // Mayor velocidad de la traza: la que acota al destino
+    double velocidad = 0.0;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        tesis::Recorrido puntos = trayectorias.Get (i);
+        for (uint64_t k = 1; k < puntos.size (); ++k)
+        {
+            double dt = puntos[k].t - puntos[k - 1].t;
+            if (dt > 0)
+            {
+                velocidad = std::max (velocidad, std::hypot (puntos[k].x - puntos[k - 1].x,
+                                                             puntos[k].y - puntos[k - 1].y) / dt);
+            }
+        }
+    }
+
+    std::vector<Modo> modos;
+    modos.push_back (Modo { "ciego", tesis::ParametrosReenvio::Ciego (), false });
+    modos.push_back (Modo { "p=" + std::string (argc > 4 ? argv[4] : "0.5"), probabilistico, false });
+    modos.push_back (Modo { "k=" + std::to_string (contador.umbral), contador, false });
+    modos.push_back (Modo { "zona", tesis::ParametrosReenvio::Ciego (), true });
+    modos.push_back (Modo { "zona,k=" + std::to_string (contador.umbral), contador, true });
+
+    std::mt19937_64 rng (17);
+    std::uniform_real_distribution<double> u (0.0, 1.0);
+    std::vector<Resultado> resultados (modos.size (), Resultado ());
+    uint64_t grado = 0;
+    double area = 0.0;
+    for (uint32_t d = 0; d < descubrimientos; ++d)
+    {
+        double t = u (rng) * enlaces.GetDuracion ();
+        std::vector<std::vector<uint32_t> > vecinos (n);
+        for (const tesis::Enlace &e : enlaces.Get ())
+        {
+            if (e.desde <= t && t < e.hasta)
+            {
+                vecinos[e.a].push_back (e.b);
+                vecinos[e.b].push_back (e.a);
+                grado += 2;
+            }
+        }
+        std::vector<tesis::Punto> posiciones (n);
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            posiciones[i] = trayectorias.Posicion (i, t);
+        }
+        uint32_t origen = rng () % n;
+        uint32_t destino = (origen + 1 + rng () % (n - 1)) % n;
+        std::vector<char> marcado;
+        uint32_t conectados = Componente (vecinos, origen, marcado);
+
+        // Lo que el originador supo del destino en un descubrimiento anterior
+        double visto = std::max (0.0, t - u (rng) * antiguedad);
+        tesis::Punto p = trayectorias.Posicion (destino, visto);
+        tesis::Ubicacion ubicacion = { visto, p.x, p.y, velocidad };
+        tesis::UbicacionesLar ubicaciones (margen);
+        ubicaciones.Actualizar (destino, ubicacion);
+        tesis::ZonaPedido zona = ubicaciones.Zona (destino, posiciones[origen].x, posiciones[origen].y, t);
+        area += (std::min (zona.x1, double (rwp.x)) - std::max (zona.x0, 0.0))
+                * (std::min (zona.y1, double (rwp.y)) - std::max (zona.y0, 0.0));
+
+        uint64_t semilla = rng ();
+        for (size_t m = 0; m < modos.size (); ++m)
+        {
+            // La misma semilla para todos: mismo MAC mientras decidan igual
+            std::mt19937_64 azar (semilla);
+            Resultado &r = resultados[m];
+            ++r.descubrimientos;
+            r.conectados += conectados;
+            r.destinosConectados += marcado[destino];
+            double latencia = Inundar (vecinos, posiciones, origen, destino, modos[m].parametros,
+                                       modos[m].zona ? zona : tesis::ZonaPedido::Completa (), azar, r);
+            if (latencia < 0)
+            {
+                // Cobertura solo del primer RREQ
+                uint64_t alcanzados = r.alcanzados;
+                ++r.reintentos;
+                latencia = Inundar (vecinos, posiciones, origen, destino, modos[m].parametros,
+                                    tesis::ZonaPedido::Completa (), azar, r);
+                latencia += latencia < 0 ? 0.0 : NET_TRAVERSAL;
+                r.alcanzados = alcanzados;
+            }
+            if (latencia >= 0)
+            {
+                ++r.rutas;
+                r.latencia += latencia;
+            }
+        }
+    }
+
+    std::cout << entrada << ": " << n << " nodos, " << alcance << " m, grado medio "
+              << double (grado) / descubrimientos / n << ", " << descubrimientos << " descubrimientos, "
+              << "velocidad maxima " << velocidad << " m/s";
+    if (rwp.x > 0)
+    {
+        std::cout << ", zona media " << 100.0 * area / descubrimientos / (rwp.x * rwp.y) << "% del area";
+    }
+    std::cout << "\nmodo\ttx\tbytes\tperdidas\tcobertura%\treintentos\trutas%\tlatencia_ms\n";
+    for (size_t m = 0; m < modos.size (); ++m)
+    {
+        Imprimir (modos[m].nombre.c_str (), resultados[m]);
+    }
+    return 0;
+}
@@ -0,0 +1,275 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * Memoria por nodo de las tablas de rutas AODV IPv6 con direcciones
+ * completas (std::map por destino, 16 bytes por columna) y con direcciones
+ * internadas (tesis::Internador6 y TablaRutas6 por identificador).
+ *
+ * Las tablas salen de un volcado .rutas de los scripts (destino, gateway e
+ * interfaz de cada ruta de cada nodo):
+ *
+ *   memoria-aodv Pcaps/IPv6/UDP/100/aodv-ipv6.rutas
+ *
+ * o, para tamanos sin volcado, de los vecinos de cada nodo en el instante
+ * t de un escenario, como las tablas a los 8 s (::1, la direccion global
+ * propia y una ruta de enlace local por vecino):
+ *
+ *   memoria-aodv Escenarios/udptcp1000.params 123 8
+ *
+ * Con 123 m el escenario de 100 nodos da las mismas rutas por nodo que el
+ * volcado de Pcaps/IPv6/UDP/100 (unas 49).
+ *
+ * Los bytes son los pedidos al asignador (sin su sobrecosto), iguales para
+ * las dos variantes; el resto de los campos de la entrada es comun.
+ */
+
+#include "../comun/escenario-rwp.h"
+#include "../comun/internador6.h"
+#include "../comun/tabla-rutas6.h"
+#include "../comun/trayectorias.h"
+
+#include <arpa/inet.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Bytes pedidos por los std::map
+static uint64_t reservados = 0;
+
+template <typename T>
+struct Contador
+{
+    typedef T value_type;
+    Contador () {}
+    template <typename U> Contador (const Contador<U> &) {}
+    T *allocate (size_t n)
+    {
+        reservados += n * sizeof (T);
+        return std::allocator<T> ().allocate (n);
+    }
+    void deallocate (T *p, size_t n)
+    {
+        reservados -= n * sizeof (T);
+        std::allocator<T> ().deallocate (p, n);
+    }
+};
+
+template <typename T, typename U>
+bool operator== (const Contador<T> &, const Contador<U> &) { return true; }
+template <typename T, typename U>
+bool operator!= (const Contador<T> &, const Contador<U> &) { return false; }
+
+// Una fila del volcado: destino, gateway e interfaz
+struct Fila
+{
+    tesis::Direccion6 destino;
+    tesis::Direccion6 gateway;
+    tesis::Direccion6 interfaz;
+};
+
+// Campos de la entrada que no son direcciones, iguales en las dos variantes
+struct Resto
+{
+    uint32_t secuencia;
+    uint16_t saltos;
+    uint8_t estado;
+    double vencimiento;
+};
+
+struct RutaCompleta
+{
+    tesis::Direccion6 gateway;
+    tesis::Direccion6 interfaz;
+    Resto resto;
+    std::vector<tesis::Direccion6, Contador<tesis::Direccion6> > precursores;
+};
+
+struct RutaInterna
+{
+    uint32_t gateway;
+    uint32_t interfaz;
+    Resto resto;
+    std::vector<uint32_t> precursores;
+};
+
+typedef std::map<tesis::Direccion6, RutaCompleta, std::less<tesis::Direccion6>,
+                 Contador<std::pair<const tesis::Direccion6, RutaCompleta> > > TablaCompleta;
+typedef std::map<uint32_t, RutaInterna, std::less<uint32_t>,
+                 Contador<std::pair<const uint32_t, RutaInterna> > > MapaInterno;
+typedef tesis::TablaRutas6<RutaInterna, uint32_t> TablaInterna;
+
+static tesis::Direccion6
+Analizar (const std::string &texto)
+{
+    uint8_t b[16] = { 0 };
+    inet_pton (AF_INET6, texto.c_str (), b);
+    return tesis::Direccion6::Desde (b);
+}
+
+static tesis::Direccion6
+Nodo (uint32_t n, bool global)
+{
+    std::ostringstream os;
+    os << (global ? "2001:1::200:ff:fe00:" : "fe80::200:ff:fe00:") << std::hex << n + 1;
+    return Analizar (os.str ());
+}
+
+// Tablas de un volcado .rutas
+static bool
+LeerVolcado (const std::string &archivo, std::vector<std::vector<Fila> > &tablas)
+{
+    std::ifstream is (archivo.c_str ());
+    if (!is)
+    {
+        return false;
+    }
+    std::string linea;
+    while (std::getline (is, linea))
+    {
+        if (linea.compare (0, 6, "Nodo: ") == 0)
+        {
+            tablas.push_back (std::vector<Fila> ());
+            continue;
+        }
+        std::istringstream campos (linea);
+        std::string destino, gateway, interfaz, marcador;
+        if (tablas.empty () || !(campos >> destino >> gateway >> interfaz >> marcador)
+            || destino.find (':') == std::string::npos || interfaz.find (':') == std::string::npos)
+        {
+            continue;
+        }
+        Fila f = { Analizar (destino), Analizar (gateway), Analizar (interfaz) };
+        tablas.back ().push_back (f);
+    }
+    return !tablas.empty ();
+}
+
+// Tablas de vecinos a alcance metros en el instante t de un escenario
+static bool
+Vecinos (const std::string &archivo, double alcance, double t, std::vector<std::vector<Fila> > &tablas)
+{
+    tesis::Trayectorias trayectorias;
+    tesis::ParametrosRwp parametros;
+    if (archivo.size () > 7 && archivo.substr (archivo.size () - 7) == ".params")
+    {
+        if (!tesis::LeerParametrosRwp (archivo, parametros))
+        {
+            return false;
+        }
+        tesis::GeneradorRwp (parametros).Generar (trayectorias);
+    }
+    else if (!trayectorias.Leer (archivo))
+    {
+        return false;
+    }
+
+    uint32_t n = trayectorias.GetNNodos ();
+    std::vector<tesis::Punto> p (n);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        p[i] = trayectorias.Posicion (i, t);
+    }
+    tesis::Direccion6 lazo = Analizar ("::1");
+    tesis::Direccion6 cero = Analizar ("::");
+    tablas.assign (n, std::vector<Fila> ());
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        Fila propia = { Nodo (i, true), cero, Nodo (i, true) };
+        Fila lazoLocal = { lazo, lazo, lazo };
+        tablas[i].push_back (lazoLocal);
+        tablas[i].push_back (propia);
+        for (uint32_t j = 0; j < n; ++j)
+        {
+            double dx = p[i].x - p[j].x, dy = p[i].y - p[j].y;
+            if (j != i && dx * dx + dy * dy <= alcance * alcance)
+            {
+                Fila f = { Nodo (j, false), Nodo (j, false), Nodo (i, false) };
+                tablas[i].push_back (f);
+            }
+        }
+    }
+    return n > 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+    if (argc != 2 && argc != 4)
+    {
+        std::cerr << "Uso: memoria-aodv volcado.rutas\n"
+                  << "     memoria-aodv traza alcance t\n";
+        return 2;
+    }
+    std::string archivo = argv[1];
+    std::vector<std::vector<Fila> > tablas;
+    bool ok = argc == 2 ? LeerVolcado (archivo, tablas)
+                        : Vecinos (archivo, std::strtod (argv[2], 0), std::strtod (argv[3], 0), tablas);
+    if (!ok)
+    {
+        std::cerr << "No se pudo leer " << archivo << "\n";
+        return 1;
+    }
+
+    Resto resto = { 0, 1, 1, 0.0 };
+    uint64_t rutas = 0;
+
+    // Direcciones completas
+    std::vector<TablaCompleta> completas (tablas.size ());
+    for (uint32_t i = 0; i < tablas.size (); ++i)
+    {
+        for (const Fila &f : tablas[i])
+        {
+            RutaCompleta r;
+            r.gateway = f.gateway;
+            r.interfaz = f.interfaz;
+            r.resto = resto;
+            completas[i].insert (std::make_pair (f.destino, r));
+        }
+        rutas += completas[i].size ();
+    }
+    uint64_t bytesCompletas = reservados + tablas.size () * sizeof (TablaCompleta);
+
+    // Internadas, en el mismo std::map y en TablaRutas6
+    tesis::Internador6 internador;
+    std::vector<MapaInterno> mapas (tablas.size ());
+    std::vector<TablaInterna> internas (tablas.size ());
+    uint64_t antes = reservados;
+    uint64_t bytesInternas = tablas.size () * sizeof (TablaInterna);
+    for (uint32_t i = 0; i < tablas.size (); ++i)
+    {
+        for (const Fila &f : tablas[i])
+        {
+            RutaInterna r;
+            r.gateway = internador.Internar (f.gateway);
+            r.interfaz = internador.Internar (f.interfaz);
+            r.resto = resto;
+            uint32_t destino = internador.Internar (f.destino);
+            mapas[i].insert (std::make_pair (destino, r));
+            internas[i].Agregar (destino, r);
+        }
+        bytesInternas += internas[i].GetMemoria ();
+    }
+    uint64_t bytesMapas = reservados - antes + tablas.size () * sizeof (MapaInterno);
+
+    // La tabla comun de direcciones se reparte entre los nodos
+    double nodos = tablas.size ();
+    double comun = internador.GetMemoria () / nodos;
+    double porNodoCompletas = bytesCompletas / nodos;
+    double porNodoMapas = bytesMapas / nodos + comun;
+    double porNodoInternas = bytesInternas / nodos + comun;
+    std::cout << archivo << ": " << tablas.size () << " nodos, " << rutas / nodos << " rutas por nodo, "
+              << internador.size () << " direcciones (" << comun << " bytes por nodo de la tabla comun)\n"
+              << "  std::map, direcciones completas:  " << porNodoCompletas << " bytes por nodo\n"
+              << "  std::map, internadas:             " << porNodoMapas << " bytes por nodo ("
+              << 100.0 * (1.0 - porNodoMapas / porNodoCompletas) << "% menos)\n"
+              << "  TablaRutas6, internadas:          " << porNodoInternas << " bytes por nodo ("
+              << 100.0 * (1.0 - porNodoInternas / porNodoCompletas) << "% menos)\n";
+    return 0;
+}
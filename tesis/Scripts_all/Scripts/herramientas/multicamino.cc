@@ -0,0 +1,407 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * AODV de un camino frente al modo multicamino de tesis::RutasMultiples
+ * sobre la linea de tiempo exacta de enlaces de un escenario
+ * (tesis::Enlaces).
+ *
+ * Cada flujo manda un paquete cada intervalo segundos desde que arranca.
+ * Un descubrimiento se emula sobre los enlaces de ese instante con las
+ * tablas de todos los nodos: el RREQ avanza por niveles (cada nodo reenvia
+ * la primera copia) y cada copia que se escucha ofrece un camino inverso
+ * hacia el originador; el destino contesta a las copias con distinto
+ * primer salto, hasta caminos RREP, y cada RREP vuelve por un camino
+ * inverso distinto de los que ya uso ese nodo, dejando caminos hacia el
+ * destino. Con caminos = 1 es AODV: un RREP por la primera copia.
+ *
+ * El paquete sigue la ruta activa de cada nodo. Si el enlace ya no existe
+ * el envio falla (7 reintentos del MAC) y el nodo pasa a su siguiente
+ * camino; si no le queda ninguno manda un RERR al anterior, que quita ese
+ * camino y prueba los suyos. Si el originador se queda sin caminos hace
+ * un descubrimiento nuevo, y si no hay ruta lo repite cada
+ * NetTraversalTime (2.8 s).
+ *
+ * Para cada modo da los enlaces rotos encontrados, los que se resolvieron
+ * sin inundar, los redescubrimientos, la latencia media de recuperacion
+ * (del envio al destino, para los paquetes que encontraron un enlace
+ * roto), el tiempo sin ruta y los bucles (siempre 0). El flujo 0 es el del
+ * script, del nodo 80 al 1; los demas, pares al azar.
+ *
+ *   multicamino traza alcance [flujos] [caminos] [intervalo]
+ *   multicamino Escenarios/udptcp100.ns_movements 100 20 3 0.25
+ */
+
+#include "../comun/enlaces.h"
+#include "../comun/escenario-rwp.h"
+#include "../comun/rutas-multiples.h"
+#include "../comun/trayectorias.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Un salto de datos y un envio que agota los reintentos del MAC, s
+static const double SALTO = 0.002;
+static const double FALLO_MAC = 0.02;
+// Jitter medio del reenvio de un RREQ
+static const double JITTER = 0.005;
+static const double NET_TRAVERSAL = 2.8;
+// ActiveRouteTimeout, en pasos de 1 ns
+static const int64_t VIDA = 3000000000LL;
+static const uint32_t NINGUNO = 0xffffffff;
+
+struct Resultado
+{
+    uint64_t paquetes;
+    uint64_t rotos;
+    uint64_t cambios;
+    uint64_t descubrimientos;
+    uint64_t recuperados;
+    double recuperacion;
+    double sinRuta;
+    uint64_t bucles;
+};
+
+static int64_t
+Pasos (double t)
+{
+    return int64_t (t * 1e9);
+}
+
+class Flujo
+{
+public:
+    Flujo (const tesis::Enlaces &enlaces, uint32_t origen, uint32_t destino, uint32_t caminos, uint64_t semilla)
+      : m_enlaces (enlaces),
+        m_origen (origen),
+        m_destino (destino),
+        m_caminos (caminos),
+        m_secuencia (0),
+        m_rng (semilla)
+    {
+        Reiniciar ();
+    }
+
+    // Descubrimiento en t; devuelve cuando llega el primer RREP, o -1
+    double Descubrir (double t, Resultado &r);
+
+    // Manda un paquete en t con las tablas actuales; devuelve la demora o
+    // -1 si el originador se quedo sin caminos
+    double Enviar (double t, bool &roto, Resultado &r);
+
+private:
+    void Reiniciar ();
+
+    const tesis::Enlaces &m_enlaces;
+    uint32_t m_origen;
+    uint32_t m_destino;
+    uint32_t m_caminos;
+    uint32_t m_secuencia;
+    std::mt19937_64 m_rng;
+    std::vector<tesis::RutasMultiples> m_tablas;
+};
+
+void
+Flujo::Reiniciar ()
+{
+    m_tablas.assign (m_enlaces.GetNNodos (), tesis::RutasMultiples (m_caminos, VIDA));
+}
+
+double
+Flujo::Descubrir (double t, Resultado &r)
+{
+    ++r.descubrimientos;
+    ++m_secuencia;
+    uint32_t n = m_enlaces.GetNNodos ();
+    int64_t ahora = Pasos (t);
+    std::vector<std::vector<uint32_t> > vecinos (n);
+    for (const tesis::Enlace &e : m_enlaces.Get ())
+    {
+        if (e.desde <= t && t < e.hasta)
+        {
+            vecinos[e.a].push_back (e.b);
+            vecinos[e.b].push_back (e.a);
+        }
+    }
+
+    // RREQ por niveles; primer salto de la copia que reenvia cada nodo
+    std::vector<uint32_t> primero (n, NINGUNO), nivel (1, m_origen);
+    std::vector<char> reenviado (n, 0);
+    reenviado[m_origen] = 1;
+    // Copias que llegan al destino: vecino y primer salto
+    std::vector<std::pair<uint32_t, uint32_t> > copias;
+    uint32_t saltosDestino = 0;
+    for (uint32_t saltos = 1; !nivel.empty (); ++saltos)
+    {
+        std::shuffle (nivel.begin (), nivel.end (), m_rng);
+        std::vector<uint32_t> siguiente;
+        for (uint32_t j : nivel)
+        {
+            uint32_t anunciado = j == m_origen ? 0 : m_tablas[j].Anunciar (m_origen);
+            for (uint32_t i : vecinos[j])
+            {
+                if (i == m_origen)
+                {
+                    continue;
+                }
+                uint32_t ultimo = j == m_origen ? i : primero[j];
+                m_tablas[i].Actualizar (m_origen, m_secuencia, j, anunciado, ultimo, ahora);
+                if (i == m_destino)
+                {
+                    if (copias.empty ())
+                    {
+                        saltosDestino = saltos;
+                    }
+                    copias.push_back (std::make_pair (j, ultimo));
+                }
+                else if (!reenviado[i])
+                {
+                    reenviado[i] = 1;
+                    primero[i] = ultimo;
+                    siguiente.push_back (i);
+                }
+            }
+        }
+        nivel.swap (siguiente);
+    }
+    if (copias.empty ())
+    {
+        return -1.0;
+    }
+
+    // RREP por copias con distinto primer salto
+    std::vector<uint32_t> usados (n, 0), primeros;
+    double llegada = -1.0;
+    for (const std::pair<uint32_t, uint32_t> &copia : copias)
+    {
+        if (primeros.size () == m_caminos)
+        {
+            break;
+        }
+        if (std::find (primeros.begin (), primeros.end (), copia.second) != primeros.end ())
+        {
+            continue;
+        }
+        primeros.push_back (copia.second);
+        uint32_t emisor = m_destino, x = copia.first, anunciado = 0, ultimo = copia.first;
+        for (uint32_t saltos = 1; saltos <= n; ++saltos)
+        {
+            bool nuevo = m_tablas[x].Actualizar (m_destino, m_secuencia, emisor, anunciado, ultimo, ahora);
+            if (x == m_origen)
+            {
+                if (nuevo && llegada < 0)
+                {
+                    llegada = saltosDestino * (SALTO + JITTER) + saltos * SALTO;
+                }
+                break;
+            }
+            const tesis::Camino *inverso = m_tablas[x].Buscar (m_origen, ahora, usados[x]++);
+            if (!nuevo || inverso == 0)
+            {
+                break;
+            }
+            anunciado = m_tablas[x].Anunciar (m_destino);
+            emisor = x;
+            x = inverso->siguiente;
+        }
+    }
+    return llegada;
+}
+
+double
+Flujo::Enviar (double t, bool &roto, Resultado &r)
+{
+    int64_t ahora = Pasos (t);
+    double demora = 0.0;
+    std::vector<uint32_t> camino (1, m_origen);
+    std::vector<char> visitado (m_enlaces.GetNNodos (), 0);
+    visitado[m_origen] = 1;
+    while (camino.back () != m_destino)
+    {
+        uint32_t x = camino.back ();
+        const tesis::Camino *c = m_tablas[x].Buscar (m_destino, ahora);
+        if (c == 0)
+        {
+            if (x == m_origen)
+            {
+                return -1.0;
+            }
+            // RERR al anterior, que deja de usar ese camino
+            camino.pop_back ();
+            visitado[x] = 0;
+            demora += SALTO;
+            m_tablas[camino.back ()].Fallo (m_destino, x);
+            continue;
+        }
+        uint32_t siguiente = c->siguiente;
+        if (!m_enlaces.Conectados (x, siguiente, t))
+        {
+            roto = true;
+            ++r.rotos;
+            demora += FALLO_MAC;
+            r.cambios += m_tablas[x].Fallo (m_destino, siguiente);
+            continue;
+        }
+        if (visitado[siguiente])
+        {
+            ++r.bucles;
+            return -1.0;
+        }
+        m_tablas[x].Usar (m_destino, ahora);
+        visitado[siguiente] = 1;
+        camino.push_back (siguiente);
+        demora += SALTO;
+    }
+    return demora;
+}
+
+static void
+Simular (const tesis::Enlaces &enlaces, uint32_t origen, uint32_t destino, uint32_t caminos, double intervalo,
+         uint64_t semilla, Resultado &r)
+{
+    Flujo flujo (enlaces, origen, destino, caminos, semilla);
+    double fin = enlaces.GetDuracion ();
+    double t = 0.0;
+    bool primero = true;
+    while (t < fin)
+    {
+        ++r.paquetes;
+        bool roto = false;
+        double demora = flujo.Enviar (t, roto, r);
+        if (demora < 0)
+        {
+            // Descubrimientos hasta tener ruta; el paquete espera en la cola
+            demora = 0.0;
+            double resto = -1.0;
+            while (resto < 0 && t + demora < fin)
+            {
+                double llegada = flujo.Descubrir (t + demora, r);
+                if (llegada < 0)
+                {
+                    demora += NET_TRAVERSAL;
+                    continue;
+                }
+                demora += llegada;
+                resto = flujo.Enviar (t + demora, roto, r);
+            }
+            if (resto < 0)
+            {
+                r.sinRuta += primero ? 0.0 : fin - t;
+                break;
+            }
+            demora += resto;
+            if (!primero)
+            {
+                roto = true;
+                r.sinRuta += demora;
+            }
+        }
+        if (roto)
+        {
+            ++r.recuperados;
+            r.recuperacion += demora;
+        }
+        primero = false;
+        t += std::max (intervalo, demora);
+    }
+}
+
+static void
+Imprimir (uint32_t caminos, const Resultado &r)
+{
+    std::cout << caminos << "\t" << r.paquetes << "\t" << r.rotos << "\t" << r.cambios << "\t"
+              << r.descubrimientos << "\t" << (r.recuperados > 0 ? 1000.0 * r.recuperacion / r.recuperados : 0.0)
+              << "\t" << r.sinRuta << "\t" << r.bucles << "\n";
+}
+
+int
+main (int argc, char *argv[])
+{
+    if (argc < 3 || argc > 6)
+    {
+        std::cerr << "Uso: multicamino traza alcance [flujos] [caminos] [intervalo]\n";
+        return 2;
+    }
+    std::string entrada = argv[1];
+    double alcance = std::strtod (argv[2], 0);
+    uint32_t flujos = argc > 3 ? std::strtoul (argv[3], 0, 10) : 20;
+    uint32_t caminos = argc > 4 ? std::strtoul (argv[4], 0, 10) : 3;
+    double intervalo = argc > 5 ? std::strtod (argv[5], 0) : 0.25;
+
+    tesis::Trayectorias trayectorias;
+    tesis::ParametrosRwp rwp;
+    double duracion = 0.0;
+    if (entrada.size () > 7 && entrada.substr (entrada.size () - 7) == ".params")
+    {
+        if (!tesis::LeerParametrosRwp (entrada, rwp))
+        {
+            std::cerr << "No se pudo leer " << entrada << " o no es RandomWaypoint\n";
+            return 1;
+        }
+        tesis::GeneradorRwp (rwp).Generar (trayectorias);
+        duracion = rwp.duracion;
+    }
+    else if (!trayectorias.Leer (entrada))
+    {
+        std::cerr << "No se pudo leer " << entrada << "\n";
+        return 1;
+    }
+    tesis::Enlaces enlaces;
+    // Sin duracion: hasta el ultimo punto de paso
+    enlaces.Calcular (trayectorias, alcance, duracion);
+    uint32_t n = enlaces.GetNNodos ();
+    if (n < 2 || intervalo <= 0)
+    {
+        std::cerr << "Hacen falta al menos dos nodos y un intervalo positivo\n";
+        return 1;
+    }
+
+    std::mt19937_64 rng (23);
+    std::vector<std::pair<uint32_t, uint32_t> > pares;
+    if (n > 80)
+    {
+        pares.push_back (std::make_pair (80u, 1u));
+    }
+    while (pares.size () < flujos)
+    {
+        uint32_t a = rng () % n;
+        pares.push_back (std::make_pair (a, (a + 1 + rng () % (n - 1)) % n));
+    }
+
+    std::cout << entrada << ": " << n << " nodos, " << alcance << " m, " << enlaces.Get ().size ()
+              << " intervalos de enlace, un paquete cada " << intervalo << " s\n";
+    std::cout << "caminos\tpaquetes\trotos\tsin_inundar\tdescubrimientos\trecuperacion_ms\tsin_ruta_s\tbucles\n";
+    Resultado total[2] = { Resultado (), Resultado () };
+    for (size_t f = 0; f < pares.size (); ++f)
+    {
+        uint64_t semilla = rng ();
+        Resultado uno = Resultado (), varios = Resultado ();
+        Simular (enlaces, pares[f].first, pares[f].second, 1, intervalo, semilla, uno);
+        Simular (enlaces, pares[f].first, pares[f].second, caminos, intervalo, semilla, varios);
+        if (f == 0)
+        {
+            std::cout << "Flujo " << pares[f].first << " -> " << pares[f].second << "\n";
+            Imprimir (1, uno);
+            Imprimir (caminos, varios);
+        }
+        Resultado *sumas[2] = { &uno, &varios };
+        for (int m = 0; m < 2; ++m)
+        {
+            total[m].paquetes += sumas[m]->paquetes;
+            total[m].rotos += sumas[m]->rotos;
+            total[m].cambios += sumas[m]->cambios;
+            total[m].descubrimientos += sumas[m]->descubrimientos;
+            total[m].recuperados += sumas[m]->recuperados;
+            total[m].recuperacion += sumas[m]->recuperacion;
+            total[m].sinRuta += sumas[m]->sinRuta;
+            total[m].bucles += sumas[m]->bucles;
+        }
+    }
+    std::cout << "Todos los flujos (" << pares.size () << ")\n";
+    Imprimir (1, total[0]);
+    Imprimir (caminos, total[1]);
+    return total[0].bucles + total[1].bucles == 0 ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * Plan de reparto espacial de un escenario entre procesos
+ * (tesis::PlanParticion) a partir de su linea de tiempo de enlaces:
+ *
+ *   particion Escenarios/udptcp5000.params 150 150 2,4,8
+ *
+ * Argumentos: traza (texto, compilada o .params), alcance en metros (150
+ * es el de la potencia de los scripts con el umbral de deteccion de -96
+ * dBm), duracion en segundos (0 = hasta el ultimo punto de paso), lista de
+ * numeros de procesos e hilos (0 = uno por nucleo). Los enlaces se calculan
+ * una vez y se reparten para cada numero de procesos.
+ *
+ * Es solo el plan: el canal wifi es un objeto compartido por todos los
+ * nodos y el simulador distribuido de ns-3 solo sincroniza procesos a
+ * traves de enlaces punto a punto, asi que los scripts siguen corriendo en
+ * un solo proceso.
+ */
+
+#include "../comun/enlaces.h"
+#include "../comun/escenario-rwp.h"
+#include "../comun/particion.h"
+#include "../comun/trayectorias.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+int
+main (int argc, char *argv[])
+{
+    if (argc < 5 || argc > 6)
+    {
+        std::cerr << "Uso: particion traza alcance duracion procesos[,procesos...] [hilos]\n";
+        return 2;
+    }
+    std::string entrada = argv[1];
+    double alcance = std::strtod (argv[2], 0);
+    double duracion = std::strtod (argv[3], 0);
+    uint32_t hilos = argc > 5 ? std::strtoul (argv[5], 0, 10) : 0;
+
+    std::vector<uint32_t> particiones;
+    std::istringstream lista (argv[4]);
+    std::string parte;
+    while (std::getline (lista, parte, ','))
+    {
+        uint32_t p = std::strtoul (parte.c_str (), 0, 10);
+        if (p < 2)
+        {
+            std::cerr << "Se necesitan al menos 2 procesos: " << parte << "\n";
+            return 2;
+        }
+        particiones.push_back (p);
+    }
+
+    tesis::Trayectorias trayectorias;
+    tesis::ParametrosRwp parametros;
+    if (entrada.size () > 7 && entrada.substr (entrada.size () - 7) == ".params")
+    {
+        if (!tesis::LeerParametrosRwp (entrada, parametros))
+        {
+            std::cerr << "No se pudo leer " << entrada << " o no es RandomWaypoint\n";
+            return 1;
+        }
+        tesis::GeneradorRwp (parametros).Generar (trayectorias, hilos);
+        if (duracion <= 0.0)
+        {
+            duracion = parametros.duracion;
+        }
+    }
+    else if (!trayectorias.Leer (entrada))
+    {
+        std::cerr << "No se pudo leer " << entrada << "\n";
+        return 1;
+    }
+
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now ();
+    tesis::Enlaces enlaces;
+    enlaces.Calcular (trayectorias, alcance, duracion, hilos);
+    double calculo = std::chrono::duration<double> (std::chrono::steady_clock::now () - inicio).count ();
+    std::cout << entrada << ": " << trayectorias.GetNNodos () << " nodos, alcance " << alcance
+              << " m, " << enlaces.GetDuracion () << " s, " << enlaces.Get ().size ()
+              << " intervalos de enlace en " << calculo * 1e3 << " ms\n";
+
+    for (uint32_t p : particiones)
+    {
+        tesis::PlanParticion (trayectorias, enlaces, p).Reporte (std::cout);
+    }
+    return 0;
+}
@@ -0,0 +1,269 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * Banco de la memorizacion de la perdida de propagacion por par de nodos,
+ * el esquema que se probo como tesis::PerdidaMemorizada y se saco de los
+ * scripts porque era mas lento que el modelo que envolvia.
+ *
+ * La tabla es de mapeo directo por (emisor, receptor) y reutiliza la
+ * ganancia mientras ninguno de los dos se movio mas de la mitad de la
+ * distancia que cambiaria la perdida log-distancia en la tolerancia. Para
+ * saberlo necesita las dos posiciones, que es justo lo caro de la consulta
+ * (MovilidadTrayectoria las evalua con una busqueda binaria); lo que se
+ * ahorra es un log10.
+ *
+ * Cada nodo del escenario transmite cada --intervalo s (como un HELLO, con
+ * un desfasaje al azar) y el canal consulta la perdida hacia todos los
+ * demas, como YansWifiChannel. Las dos variantes leen las posiciones de la
+ * trayectoria en cada consulta. Se imprime el costo por consulta de cada
+ * una, los aciertos de la tabla y el error maximo de la memorizada:
+ *
+ *   perdida-memorizada traza [duracion] [intervalo] [tolerancia] [entradas]
+ *   perdida-memorizada Escenarios/udptcp100.ns_movements 150 1 0.1 65536
+ *
+ * La traza puede ser texto, compilada o un .params. Duracion 0 = hasta el
+ * ultimo punto de paso.
+ */
+
+#include "../comun/escenario-rwp.h"
+#include "../comun/trayectorias.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Modelo log-distancia de YansWifiChannelHelper::Default ()
+static const double EXPONENTE = 3.0;
+static const double PERDIDA_REFERENCIA = 46.6777;
+
+// Una transmision: emisor e instante
+struct Transmision
+{
+    double t;
+    uint32_t nodo;
+
+    bool operator< (const Transmision &o) const { return t < o.t; }
+};
+
+static double
+Distancia (const tesis::Punto &a, const tesis::Punto &b)
+{
+    return std::sqrt ((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y));
+}
+
+static double
+Ganancia (double distancia)
+{
+    return -PERDIDA_REFERENCIA - 10.0 * EXPONENTE * std::log10 (std::max (distancia, 1.0));
+}
+
+// La tabla de la PerdidaMemorizada, con indices de nodo como clave
+class TablaPerdida
+{
+public:
+    TablaPerdida (uint32_t entradas, double tolerancia)
+      : m_factor ((std::pow (10.0, tolerancia / (10.0 * EXPONENTE)) - 1.0) / 2.0),
+        m_aciertos (0),
+        m_fallos (0),
+        m_reemplazos (0)
+    {
+        uint32_t n = 1;
+        while (n < entradas)
+        {
+            n <<= 1;
+        }
+        Entrada vacia = { NINGUNO, NINGUNO, tesis::Punto (), tesis::Punto (), 0.0, 0.0 };
+        m_tabla.assign (n, vacia);
+    }
+
+    double Consultar (uint32_t a, uint32_t b, const tesis::Punto &pa, const tesis::Punto &pb)
+    {
+        uint64_t h = (uint64_t (a) + 1) * 0x9E3779B97F4A7C15ULL ^ b;
+        h ^= h >> 29;
+        Entrada &e = m_tabla[(h * 0xBF58476D1CE4E5B9ULL >> 32) & (m_tabla.size () - 1)];
+        if (e.a == a && e.b == b && Distancia (pa, e.pa) <= e.holgura && Distancia (pb, e.pb) <= e.holgura)
+        {
+            ++m_aciertos;
+            return e.ganancia;
+        }
+        if (e.a != NINGUNO && (e.a != a || e.b != b))
+        {
+            ++m_reemplazos;
+        }
+        ++m_fallos;
+        double d = Distancia (pa, pb);
+        e.a = a;
+        e.b = b;
+        e.pa = pa;
+        e.pb = pb;
+        e.ganancia = Ganancia (d);
+        e.holgura = d * m_factor;
+        return e.ganancia;
+    }
+
+    uint64_t GetAciertos () const { return m_aciertos; }
+    uint64_t GetConsultas () const { return m_aciertos + m_fallos; }
+    uint64_t GetReemplazos () const { return m_reemplazos; }
+    uint64_t GetEntradas () const { return m_tabla.size (); }
+
+private:
+    static const uint32_t NINGUNO = 0xffffffff;
+
+    struct Entrada
+    {
+        uint32_t a;
+        uint32_t b;
+        tesis::Punto pa;
+        tesis::Punto pb;
+        double ganancia;
+        double holgura;
+    };
+
+    std::vector<Entrada> m_tabla;
+    double m_factor;
+    uint64_t m_aciertos;
+    uint64_t m_fallos;
+    uint64_t m_reemplazos;
+};
+
+int
+main (int argc, char *argv[])
+{
+    if (argc < 2 || argc > 6)
+    {
+        std::cerr << "Uso: perdida-memorizada traza [duracion] [intervalo] [tolerancia] [entradas]\n";
+        return 2;
+    }
+    std::string entrada = argv[1];
+    double duracion = argc > 2 ? std::strtod (argv[2], 0) : 150.0;
+    double intervalo = argc > 3 ? std::strtod (argv[3], 0) : 1.0;
+    double tolerancia = argc > 4 ? std::strtod (argv[4], 0) : 0.1;
+    uint32_t entradas = argc > 5 ? std::strtoul (argv[5], 0, 10) : 1 << 16;
+    if (intervalo <= 0 || tolerancia < 0 || entradas == 0)
+    {
+        std::cerr << "Intervalo, tolerancia o entradas no validos\n";
+        return 2;
+    }
+
+    tesis::Trayectorias trayectorias;
+    tesis::ParametrosRwp parametros;
+    if (entrada.size () > 7 && entrada.substr (entrada.size () - 7) == ".params")
+    {
+        if (!tesis::LeerParametrosRwp (entrada, parametros))
+        {
+            std::cerr << "No se pudo leer " << entrada << " o no es RandomWaypoint\n";
+            return 1;
+        }
+        tesis::GeneradorRwp (parametros).Generar (trayectorias);
+    }
+    else if (!trayectorias.Leer (entrada))
+    {
+        std::cerr << "No se pudo leer " << entrada << "\n";
+        return 1;
+    }
+
+    std::vector<uint32_t> nodos;
+    double ultimo = 0.0;
+    for (uint32_t n = 0; n < trayectorias.GetNNodos (); ++n)
+    {
+        if (trayectorias.Tiene (n))
+        {
+            nodos.push_back (n);
+            ultimo = std::max (ultimo, trayectorias.Get (n).back ().t);
+        }
+    }
+    if (duracion <= 0.0)
+    {
+        duracion = ultimo;
+    }
+
+    std::mt19937 azar (1);
+    std::uniform_real_distribution<double> desfasaje (0.0, intervalo);
+    std::vector<Transmision> transmisiones;
+    for (uint32_t n : nodos)
+    {
+        for (double t = desfasaje (azar); t < duracion; t += intervalo)
+        {
+            Transmision x = { t, n };
+            transmisiones.push_back (x);
+        }
+    }
+    std::sort (transmisiones.begin (), transmisiones.end ());
+
+    // Modelo exacto: posiciones, distancia y log10 en cada consulta
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now ();
+    double sumaExacta = 0.0;
+    uint64_t consultas = 0;
+    for (const Transmision &x : transmisiones)
+    {
+        for (uint32_t r : nodos)
+        {
+            if (r == x.nodo)
+            {
+                continue;
+            }
+            tesis::Punto pa = trayectorias.Posicion (x.nodo, x.t);
+            tesis::Punto pb = trayectorias.Posicion (r, x.t);
+            sumaExacta += Ganancia (Distancia (pa, pb));
+            ++consultas;
+        }
+    }
+    double exacta = std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now () - inicio).count ();
+
+    // Memorizada: las mismas posiciones, la tabla decide si recalcular
+    TablaPerdida tabla (entradas, tolerancia);
+    inicio = std::chrono::steady_clock::now ();
+    double sumaMemorizada = 0.0;
+    for (const Transmision &x : transmisiones)
+    {
+        for (uint32_t r : nodos)
+        {
+            if (r == x.nodo)
+            {
+                continue;
+            }
+            tesis::Punto pa = trayectorias.Posicion (x.nodo, x.t);
+            tesis::Punto pb = trayectorias.Posicion (r, x.t);
+            sumaMemorizada += tabla.Consultar (x.nodo, r, pa, pb);
+        }
+    }
+    double memorizada = std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now () - inicio).count ();
+
+    // Error fuera del tiempo medido, con una tabla nueva
+    TablaPerdida comprobacion (entradas, tolerancia);
+    double errorMaximo = 0.0;
+    for (const Transmision &x : transmisiones)
+    {
+        for (uint32_t r : nodos)
+        {
+            if (r == x.nodo)
+            {
+                continue;
+            }
+            tesis::Punto pa = trayectorias.Posicion (x.nodo, x.t);
+            tesis::Punto pb = trayectorias.Posicion (r, x.t);
+            double error = std::fabs (comprobacion.Consultar (x.nodo, r, pa, pb) - Ganancia (Distancia (pa, pb)));
+            errorMaximo = std::max (errorMaximo, error);
+        }
+    }
+
+    if (consultas == 0)
+    {
+        std::cerr << "Sin consultas: el escenario necesita al menos dos nodos\n";
+        return 1;
+    }
+    std::cout << entrada << ": " << nodos.size () << " nodos, " << transmisiones.size ()
+              << " transmisiones, " << consultas << " consultas\n"
+              << "log-distancia " << exacta / consultas << " ns/consulta, memorizada "
+              << memorizada / consultas << " ns/consulta (" << exacta / memorizada << "x)\n"
+              << "aciertos " << 100.0 * tabla.GetAciertos () / tabla.GetConsultas () << "%, "
+              << tabla.GetReemplazos () << " reemplazos, tabla de " << tabla.GetEntradas ()
+              << " entradas, error maximo " << errorMaximo << " dB (tolerancia " << tolerancia << ")\n"
+              << "(sumas " << sumaExacta << " " << sumaMemorizada << ")\n";
+    return errorMaximo <= tolerancia + 1e-9 ? 0 : 1;
+}
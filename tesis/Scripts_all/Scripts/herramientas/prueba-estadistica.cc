@@ -0,0 +1,70 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * Prueba de LeerFlowMonitor (estadistica.h) contra los flowMonNodes.xml de
+ * referencia de Pcaps/IPv6 (100 nodos, un flujo).
+ *
+ * De los 140 flujos del XML de UDP, 139 son de control de AODV (puerto
+ * 654); en el de TCP tambien esta el flujo inverso de ACK. Las metricas
+ * tienen que ser las del unico flujo de datos (flowId 1).
+ *
+ *   prueba-estadistica [directorio de Pcaps/IPv6]
+ *
+ * Sin argumento busca tesis/Pcaps/IPv6 desde herramientas/ (donde se
+ * compila) o desde Scripts/.
+ *
+ * Devuelve 0 si todas las comprobaciones pasan.
+ */
+
+#include <sys/stat.h>
+
+#include <cmath>
+#include <iostream>
+#include <string>
+
+#include "estadistica.h"
+
+static int fallos = 0;
+
+static void
+Comprobar (const std::string &que, double valor, double esperado, double tolerancia)
+{
+    bool ok = std::fabs (valor - esperado) <= tolerancia;
+    std::cout << (ok ? "ok    " : "FALLA ") << que << " = " << valor << " (esperado " << esperado << ")\n";
+    fallos += !ok;
+}
+
+int
+main (int argc, char *argv[])
+{
+    std::string directorio = argc > 1 ? argv[1] : "../../../Pcaps/IPv6";
+    struct stat info;
+    if (argc <= 1 && stat (directorio.c_str (), &info) != 0)
+    {
+        directorio = "../../Pcaps/IPv6";
+    }
+
+    Metricas m;
+    if (!LeerFlowMonitor (directorio + "/UDP/100/flowMonNodes.xml", 576, m))
+    {
+        std::cerr << "No se pudo leer " << directorio << "/UDP/100/flowMonNodes.xml\n";
+        return 1;
+    }
+    // Flujo 1: 67 de 100 paquetes, delaySum 0.421352266 s, 71824 bytes
+    // entre 20 s y 119.001804296 s
+    Comprobar ("UDP pdr", m.pdr, 0.67, 1e-9);
+    Comprobar ("UDP retardo", m.retardo, 0.421352266 / 67, 1e-9);
+    Comprobar ("UDP throughput", m.throughput, 71824 * 8 / (119.001804296 - 20.0) / 1000, 1e-6);
+
+    if (!LeerFlowMonitor (directorio + "/TCP/100/flowMonNodes.xml", 8080, m))
+    {
+        std::cerr << "No se pudo leer " << directorio << "/TCP/100/flowMonNodes.xml\n";
+        return 1;
+    }
+    // Flujo 1 (el 140 son los ACK hacia el puerto 49153)
+    Comprobar ("TCP pdr", m.pdr, 10604.0 / 10651, 1e-9);
+    Comprobar ("TCP retardo", m.retardo, 207.210626259 / 10604, 1e-9);
+
+    std::cout << (fallos == 0 ? "Todas las pruebas pasaron\n" : "Hubo fallos\n");
+    return fallos == 0 ? 0 : 1;
+}
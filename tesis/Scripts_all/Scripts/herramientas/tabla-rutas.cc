@@ -0,0 +1,218 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * Microbanco de la tabla de rutas IPv6: tesis::TablaRutas6 frente al
+ * std::map ordenado por direccion que usa la tabla de AODV.
+ *
+ * Para 100, 300 y 1000 destinos (o los de la linea de comandos) con las
+ * direcciones que aparecen en los volcados .rutas (fe80::200:ff:fe00:N y
+ * 2001:1::200:ff:fe00:N) mide el costo de una busqueda (90% aciertos) y
+ * de recorrer la tabla entera, como hace la purga. Antes compara las dos
+ * tablas bajo altas y bajas al azar.
+ *
+ *   tabla-rutas 100 300 1000
+ */
+
+#include "../comun/tabla-rutas6.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+// Del tamano de una entrada de la tabla de AODV: direcciones de destino,
+// siguiente salto e interfaz, secuencia, saltos, vencimiento y estado
+struct Ruta
+{
+    uint8_t siguiente[16];
+    uint8_t interfaz[16];
+    uint32_t secuencia;
+    uint16_t saltos;
+    uint8_t estado;
+    double vencimiento;
+    uint8_t resto[48];
+};
+
+static tesis::Direccion6
+Direccion (uint32_t n, bool global)
+{
+    uint8_t b[16] = { 0xfe, 0x80, 0, 0, 0, 0, 0, 0, 0x02, 0x00, 0x00, 0xff, 0xfe, 0, 0, 0 };
+    if (global)
+    {
+        b[0] = 0x20;
+        b[1] = 0x01;
+        b[3] = 0x01;
+    }
+    b[13] = n >> 16;
+    b[14] = n >> 8;
+    b[15] = n;
+    return tesis::Direccion6::Desde (b);
+}
+
+static Ruta
+NuevaRuta (uint32_t n)
+{
+    Ruta r = Ruta ();
+    r.secuencia = n;
+    r.saltos = n % 7 + 1;
+    r.vencimiento = n;
+    return r;
+}
+
+// Altas, bajas y busquedas al azar contra std::map
+static bool
+Comprobar ()
+{
+    std::mt19937 rng (1);
+    std::map<tesis::Direccion6, Ruta> mapa;
+    tesis::TablaRutas6<Ruta> tabla;
+    for (uint32_t i = 0; i < 200000; ++i)
+    {
+        uint32_t n = rng () % 3000;
+        tesis::Direccion6 d = Direccion (n, n & 1);
+        switch (rng () % 3)
+        {
+        case 0:
+            if (mapa.insert (std::make_pair (d, NuevaRuta (n))).second != tabla.Agregar (d, NuevaRuta (n)))
+            {
+                return false;
+            }
+            break;
+        case 1:
+            if ((mapa.erase (d) == 1) != tabla.Borrar (d))
+            {
+                return false;
+            }
+            break;
+        default:
+            {
+                std::map<tesis::Direccion6, Ruta>::iterator i = mapa.find (d);
+                const Ruta *r = tabla.Buscar (d);
+                if ((i == mapa.end ()) != (r == 0) || (r != 0 && r->secuencia != i->second.secuencia))
+                {
+                    return false;
+                }
+            }
+        }
+        if (i % 50000 == 0)
+        {
+            // Purga de la mitad de las rutas
+            tabla.BorrarSi ([] (const tesis::TablaRutas6<Ruta>::Entrada &e) { return e.valor.secuencia % 2 == 0; });
+            for (std::map<tesis::Direccion6, Ruta>::iterator i = mapa.begin (); i != mapa.end (); )
+            {
+                i = i->second.secuencia % 2 == 0 ? mapa.erase (i) : ++i;
+            }
+        }
+    }
+    return mapa.size () == tabla.size ();
+}
+
+template <typename F>
+static double
+Nanosegundos (uint64_t operaciones, F f)
+{
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now ();
+    f ();
+    return std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now () - inicio).count () / operaciones;
+}
+
+static void
+Medir (uint32_t destinos)
+{
+    std::map<tesis::Direccion6, Ruta> mapa;
+    tesis::TablaRutas6<Ruta> tabla;
+    std::vector<tesis::Direccion6> presentes;
+    for (uint32_t n = 0; n < destinos; ++n)
+    {
+        // La mitad de enlace local (vecinos), la mitad globales
+        tesis::Direccion6 d = Direccion (n / 2 + 1, n % 2);
+        mapa.insert (std::make_pair (d, NuevaRuta (n)));
+        tabla.Agregar (d, NuevaRuta (n));
+        presentes.push_back (d);
+    }
+
+    const uint32_t consultas = 2000000;
+    std::mt19937 rng (2);
+    std::vector<tesis::Direccion6> orden (consultas);
+    for (tesis::Direccion6 &d : orden)
+    {
+        d = rng () % 10 == 0 ? Direccion (destinos + rng () % destinos, rng () % 2) : presentes[rng () % destinos];
+    }
+
+    uint64_t suma = 0;
+    double mapaBusqueda = Nanosegundos (consultas, [&] ()
+    {
+        for (const tesis::Direccion6 &d : orden)
+        {
+            std::map<tesis::Direccion6, Ruta>::const_iterator i = mapa.find (d);
+            suma += i != mapa.end () ? i->second.saltos : 0;
+        }
+    });
+    double tablaBusqueda = Nanosegundos (consultas, [&] ()
+    {
+        for (const tesis::Direccion6 &d : orden)
+        {
+            const Ruta *r = tabla.Buscar (d);
+            suma += r != 0 ? r->saltos : 0;
+        }
+    });
+
+    const uint32_t recorridos = 20000000 / destinos;
+    double mapaRecorrido = Nanosegundos (recorridos, [&] ()
+    {
+        for (uint32_t k = 0; k < recorridos; ++k)
+        {
+            for (const auto &e : mapa)
+            {
+                suma += e.second.vencimiento < k;
+            }
+        }
+    });
+    double tablaRecorrido = Nanosegundos (recorridos, [&] ()
+    {
+        for (uint32_t k = 0; k < recorridos; ++k)
+        {
+            for (const tesis::TablaRutas6<Ruta>::Entrada &e : tabla)
+            {
+                suma += e.valor.vencimiento < k;
+            }
+        }
+    });
+
+    std::cout << destinos << "\t" << mapaBusqueda << "\t" << tablaBusqueda << "\t"
+              << mapaBusqueda / tablaBusqueda << "\t" << mapaRecorrido << "\t" << tablaRecorrido
+              << "\t" << mapaRecorrido / tablaRecorrido << "\n";
+    if (suma == 0)
+    {
+        std::cout << "\n";
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+    if (!Comprobar ())
+    {
+        std::cerr << "TablaRutas6 difiere de std::map\n";
+        return 1;
+    }
+
+    std::vector<uint32_t> tamanos;
+    for (int i = 1; i < argc; ++i)
+    {
+        tamanos.push_back (std::strtoul (argv[i], 0, 10));
+    }
+    if (tamanos.empty ())
+    {
+        tamanos = { 100, 300, 1000 };
+    }
+
+    std::cout << "destinos\tmapa_ns\ttabla_ns\tmejora\tmapa_purga_ns\ttabla_purga_ns\tmejora\n";
+    for (uint32_t n : tamanos)
+    {
+        Medir (n);
+    }
+    return 0;
+}
@@ -0,0 +1,421 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * Comprueba tesis::RuedaTemporizadores, usada como la usaria el port (un
+ * solo evento del simulador, el del proximo tick ocupado), contra un
+ * evento por entrada en un planificador std::map como el MapScheduler de
+ * ns-3, con la carga de temporizadores de AODV de cada nodo:
+ *
+ *   - 20 vecinos, vida 3 s (HelloInterval 1 s, AllowedHelloLoss 2),
+ *     renovados por un HELLO cada 0.75-1.25 s que se pierde con p = 0.15
+ *   - 10 rutas, vida 3 s (ActiveRouteTimeout), renovadas por trafico a
+ *     intervalos exponenciales de media 1.5 s; el 5% de las veces un RERR
+ *     la invalida
+ *   - 2 listas negras de 5.6 s (BlackListTimeout), puestas cada ~20 s
+ *   - la ventana de 1 s del limite de RREQ, periodica
+ *
+ * Las dos versiones recorren la misma traza de renovaciones y despues de
+ * cada una consultan dos entradas con la regla exacta (vigente si su
+ * vencimiento no paso; la ventana del limite la que contiene el instante).
+ * Tienen que dar las mismas respuestas y los mismos vencimientos. La rueda
+ * avisa cada vencimiento en el primer borde de tick en o despues de el, asi
+ * que el aviso se atrasa menos de una resolucion; la prueba falla si alguno
+ * queda fuera de [0, resolucion) o si el atraso medio pasa de media
+ * resolucion (mas 10% de margen), que es lo esperado para vencimientos
+ * repartidos al azar dentro del tick. Al final compara eventos del
+ * planificador y tiempo.
+ *
+ *   temporizadores [nodos] [segundos] [resolucion_ms]
+ *   temporizadores 1000 150 10
+ */
+
+#include "../comun/rueda-temporizadores.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+
+enum Clase { VECINO, RUTA, LISTA_NEGRA, LIMITE_RREQ };
+
+// Temporizadores de cada clase por nodo y su vida en microsegundos
+static const uint32_t CANTIDAD[] = { 20, 10, 2, 1 };
+static const int64_t VIDA[] = { 3000000, 3000000, 5600000, 1000000 };
+static const uint32_t POR_NODO = 33;
+
+static Clase
+ClaseDe (uint32_t clave)
+{
+    uint32_t i = clave % POR_NODO;
+    uint32_t c = 0;
+    while (i >= CANTIDAD[c])
+    {
+        i -= CANTIDAD[c++];
+    }
+    return Clase (c);
+}
+
+// Una renovacion (plazo > 0) o invalidacion (plazo = -1) y las dos
+// entradas que se consultan despues
+struct Accion
+{
+    int64_t t;
+    uint32_t clave;
+    int64_t plazo;
+    uint32_t consulta;
+};
+
+// Vencimiento observado: clave y plazo exacto
+typedef std::pair<uint32_t, int64_t> Vencido;
+
+struct Resultado
+{
+    std::vector<int64_t> respuestas;
+    std::vector<Vencido> vencidos;
+    uint64_t programados;
+    uint64_t ejecutados;
+    // Solo la rueda: avisos fuera de [plazo, plazo + resolucion)
+    uint64_t fuera;
+    int64_t retrasoMaximo;
+    double retrasoTotal;
+    double segundos;
+};
+
+static std::vector<Accion>
+Traza (uint32_t nodos, int64_t fin)
+{
+    std::mt19937_64 rng (7);
+    std::uniform_real_distribution<double> u (0.0, 1.0);
+    std::exponential_distribution<double> trafico (1.0 / 1.5e6);
+    std::exponential_distribution<double> listas (1.0 / 20e6);
+    uint32_t claves = nodos * POR_NODO;
+
+    typedef std::pair<int64_t, uint32_t> Proxima;
+    std::priority_queue<Proxima, std::vector<Proxima>, std::greater<Proxima> > proximas;
+    for (uint32_t k = 0; k < claves; ++k)
+    {
+        Clase c = ClaseDe (k);
+        if (c == VECINO)
+        {
+            proximas.push (Proxima (int64_t (u (rng) * 1e6), k));
+        }
+        else if (c == RUTA)
+        {
+            proximas.push (Proxima (int64_t (trafico (rng)), k));
+        }
+        else if (c == LISTA_NEGRA)
+        {
+            proximas.push (Proxima (int64_t (listas (rng)), k));
+        }
+    }
+
+    std::vector<Accion> traza;
+    while (!proximas.empty () && proximas.top ().first < fin)
+    {
+        Proxima p = proximas.top ();
+        proximas.pop ();
+        Accion a = { p.first, p.second, p.first + VIDA[ClaseDe (p.second)], uint32_t (rng () % claves) };
+        switch (ClaseDe (p.second))
+        {
+        case VECINO:
+            if (u (rng) < 0.15)
+            {
+                a.plazo = 0;
+            }
+            p.first += int64_t ((0.75 + 0.5 * u (rng)) * 1e6);
+            break;
+        case RUTA:
+            if (u (rng) < 0.05)
+            {
+                a.plazo = -1;
+            }
+            p.first += 1 + int64_t (trafico (rng));
+            break;
+        default:
+            p.first += 1 + int64_t (listas (rng));
+        }
+        if (a.plazo != 0)
+        {
+            traza.push_back (a);
+        }
+        proximas.push (p);
+    }
+    return traza;
+}
+
+// Un evento por entrada: cada renovacion cancela el evento pendiente (que
+// queda en el planificador hasta su hora, como Simulator::Cancel) e
+// inserta otro
+static Resultado
+PorEntrada (const std::vector<Accion> &traza, uint32_t claves, int64_t fin)
+{
+    Resultado r = Resultado ();
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now ();
+
+    std::vector<int64_t> plazo (claves, -1);
+    std::vector<uint64_t> generacion (claves, 0);
+    // (hora, uid) -> clave y generacion, como MapScheduler
+    std::map<std::pair<int64_t, uint64_t>, std::pair<uint32_t, uint64_t> > eventos;
+    uint64_t uid = 0;
+
+    for (uint32_t k = 0; k < claves; ++k)
+    {
+        if (ClaseDe (k) == LIMITE_RREQ)
+        {
+            plazo[k] = VIDA[LIMITE_RREQ];
+            eventos[std::make_pair (plazo[k], uid++)] = std::make_pair (k, generacion[k]);
+            ++r.programados;
+        }
+    }
+
+    // Ejecuta los eventos anteriores a t
+    auto ejecutar = [&] (int64_t t)
+    {
+        while (!eventos.empty () && eventos.begin ()->first.first < t)
+        {
+            int64_t hora = eventos.begin ()->first.first;
+            uint32_t k = eventos.begin ()->second.first;
+            bool vigente = eventos.begin ()->second.second == generacion[k];
+            eventos.erase (eventos.begin ());
+            ++r.ejecutados;
+            if (!vigente)
+            {
+                continue;
+            }
+            r.vencidos.push_back (Vencido (k, hora));
+            if (ClaseDe (k) == LIMITE_RREQ)
+            {
+                plazo[k] += VIDA[LIMITE_RREQ];
+                if (plazo[k] <= fin)
+                {
+                    eventos[std::make_pair (plazo[k], uid++)] = std::make_pair (k, generacion[k]);
+                    ++r.programados;
+                }
+            }
+            else
+            {
+                plazo[k] = -1;
+            }
+        }
+    };
+
+    r.respuestas.reserve (2 * traza.size ());
+    for (const Accion &a : traza)
+    {
+        ejecutar (a.t);
+        ++generacion[a.clave];
+        plazo[a.clave] = a.plazo;
+        if (a.plazo > 0)
+        {
+            eventos[std::make_pair (a.plazo, uid++)] = std::make_pair (a.clave, generacion[a.clave]);
+            ++r.programados;
+        }
+        r.respuestas.push_back (plazo[a.clave] >= a.t ? plazo[a.clave] : -1);
+        r.respuestas.push_back (plazo[a.consulta] >= a.t ? plazo[a.consulta] : -1);
+    }
+    ejecutar (fin + VIDA[LISTA_NEGRA] + 1);
+
+    r.segundos = std::chrono::duration<double> (std::chrono::steady_clock::now () - inicio).count ();
+    return r;
+}
+
+// Rueda con un evento por tick ocupado; las entradas guardan su plazo
+// exacto y el aviso de la rueda solo las retira
+static Resultado
+ConRueda (const std::vector<Accion> &traza, uint32_t claves, int64_t fin, int64_t resolucion)
+{
+    Resultado r = Resultado ();
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now ();
+
+    tesis::RuedaTemporizadores rueda;
+    std::vector<int64_t> plazo (claves, -1);
+    std::vector<tesis::RuedaTemporizadores::Id> ids (claves, tesis::RuedaTemporizadores::NINGUNO);
+    // Tick del evento pendiente (0 = ninguno)
+    uint64_t evento = 0;
+
+    // Redondeo hacia arriba: un plazo justo en un borde vence en ese tick
+    auto tick = [resolucion] (int64_t t) { return uint64_t ((t + resolucion - 1) / resolucion); };
+    auto planificar = [&] ()
+    {
+        uint64_t proximo = rueda.Proximo ();
+        if (proximo == 0)
+        {
+            evento = 0;
+        }
+        else if (evento == 0 || proximo < evento)
+        {
+            evento = proximo;
+            ++r.programados;
+        }
+    };
+    // Accion de vencimiento de la clave k, corrida en ahora
+    auto retirar = [&] (uint32_t k, int64_t ahora)
+    {
+        int64_t retraso = ahora - plazo[k];
+        if (retraso < 0 || retraso >= resolucion)
+        {
+            ++r.fuera;
+        }
+        r.retrasoMaximo = std::max (r.retrasoMaximo, retraso);
+        r.retrasoTotal += retraso;
+        r.vencidos.push_back (Vencido (k, plazo[k]));
+        ids[k] = tesis::RuedaTemporizadores::NINGUNO;
+        if (ClaseDe (k) == LIMITE_RREQ)
+        {
+            // Sin deriva: la ventana siguiente empieza donde termino esta
+            plazo[k] += VIDA[LIMITE_RREQ];
+            if (plazo[k] <= fin)
+            {
+                ids[k] = rueda.Programar (tick (plazo[k]), k);
+            }
+        }
+        else
+        {
+            plazo[k] = -1;
+        }
+    };
+    auto vencer = [&] (tesis::RuedaTemporizadores::Id, uint64_t k)
+    {
+        retirar (k, int64_t (rueda.GetActual ()) * resolucion);
+    };
+    // Ejecuta los eventos de la rueda anteriores a t; uno justo en t corre
+    // despues de la accion, como en el planificador
+    auto ejecutar = [&] (int64_t t)
+    {
+        while (evento != 0 && int64_t (evento) * resolucion < t)
+        {
+            ++r.ejecutados;
+            uint64_t hasta = evento;
+            evento = 0;
+            rueda.Avanzar (hasta, vencer);
+            planificar ();
+        }
+    };
+    // La rueda llega al ultimo tick anterior a t antes de tocarla, asi
+    // nunca planifica un tick pasado
+    auto sincronizar = [&] (int64_t t)
+    {
+        uint64_t anterior = uint64_t ((t + resolucion - 1) / resolucion);
+        if (anterior > rueda.GetActual () + 1)
+        {
+            rueda.Avanzar (anterior - 1, vencer);
+        }
+    };
+    // Exacto, como la entrada: vigente si el plazo no paso
+    auto consultar = [&] (uint32_t k, int64_t t)
+    {
+        if (ClaseDe (k) == LIMITE_RREQ)
+        {
+            int64_t ventana = plazo[k];
+            while (ventana < t)
+            {
+                ventana += VIDA[LIMITE_RREQ];
+            }
+            return ventana;
+        }
+        return ids[k] != tesis::RuedaTemporizadores::NINGUNO && plazo[k] >= t ? plazo[k] : int64_t (-1);
+    };
+
+    for (uint32_t k = 0; k < claves; ++k)
+    {
+        if (ClaseDe (k) == LIMITE_RREQ)
+        {
+            plazo[k] = VIDA[LIMITE_RREQ];
+            ids[k] = rueda.Programar (tick (plazo[k]), k);
+        }
+    }
+    planificar ();
+
+    r.respuestas.reserve (2 * traza.size ());
+    for (const Accion &a : traza)
+    {
+        ejecutar (a.t);
+        sincronizar (a.t);
+        tesis::RuedaTemporizadores::Id &id = ids[a.clave];
+        if (id != tesis::RuedaTemporizadores::NINGUNO && plazo[a.clave] < a.t)
+        {
+            // Vencida antes del tick que la avisa: la accion corre antes de
+            // renovarla o invalidarla, como si el evento hubiera llegado a
+            // tiempo
+            rueda.Cancelar (id);
+            retirar (a.clave, a.t);
+        }
+        if (a.plazo > 0)
+        {
+            if (id == tesis::RuedaTemporizadores::NINGUNO)
+            {
+                id = rueda.Programar (tick (a.plazo), a.clave);
+            }
+            else
+            {
+                rueda.Reprogramar (id, tick (a.plazo));
+            }
+            plazo[a.clave] = a.plazo;
+        }
+        else if (id != tesis::RuedaTemporizadores::NINGUNO)
+        {
+            rueda.Cancelar (id);
+            id = tesis::RuedaTemporizadores::NINGUNO;
+            plazo[a.clave] = -1;
+        }
+        planificar ();
+        r.respuestas.push_back (consultar (a.clave, a.t));
+        r.respuestas.push_back (consultar (a.consulta, a.t));
+    }
+    ejecutar (fin + VIDA[LISTA_NEGRA] + 2 * resolucion);
+
+    r.segundos = std::chrono::duration<double> (std::chrono::steady_clock::now () - inicio).count ();
+    return r;
+}
+
+int
+main (int argc, char *argv[])
+{
+    uint32_t nodos = argc > 1 ? std::strtoul (argv[1], 0, 10) : 100;
+    double segundos = argc > 2 ? std::strtod (argv[2], 0) : 150;
+    double resolucionMs = argc > 3 ? std::strtod (argv[3], 0) : 10;
+    int64_t fin = int64_t (segundos * 1e6);
+    int64_t resolucion = int64_t (resolucionMs * 1e3);
+    if (nodos == 0 || fin <= 0 || resolucion <= 0)
+    {
+        std::cerr << "Uso: temporizadores [nodos] [segundos] [resolucion_ms]\n";
+        return 2;
+    }
+    uint32_t claves = nodos * POR_NODO;
+
+    std::vector<Accion> traza = Traza (nodos, fin);
+    Resultado entrada = PorEntrada (traza, claves, fin);
+    Resultado rueda = ConRueda (traza, claves, fin, resolucion);
+
+    uint64_t diferencias = 0;
+    for (uint64_t i = 0; i < entrada.respuestas.size (); ++i)
+    {
+        diferencias += entrada.respuestas[i] != rueda.respuestas[i];
+    }
+    std::sort (entrada.vencidos.begin (), entrada.vencidos.end ());
+    std::sort (rueda.vencidos.begin (), rueda.vencidos.end ());
+    bool mismos = entrada.vencidos == rueda.vencidos;
+
+    std::cout << nodos << " nodos, " << claves << " temporizadores, " << segundos << " s, resolucion "
+              << resolucionMs << " ms, " << traza.size () << " renovaciones\n"
+              << "  consultas: " << entrada.respuestas.size () << ", " << diferencias << " diferencias\n"
+              << "  vencimientos: " << entrada.vencidos.size () << " por entrada, " << rueda.vencidos.size ()
+              << " en la rueda (" << (mismos ? "los mismos" : "DISTINTOS") << ")\n"
+              << "  aviso de la rueda despues del vencimiento: medio "
+              << (rueda.vencidos.empty () ? 0 : rueda.retrasoTotal / rueda.vencidos.size () / 1e3) << " ms, maximo "
+              << rueda.retrasoMaximo / 1e3 << " ms, " << rueda.fuera << " fuera de [0, resolucion)\n"
+              << "  eventos por entrada: " << entrada.programados << " programados, " << entrada.ejecutados
+              << " ejecutados, " << entrada.segundos << " s\n"
+              << "  eventos de la rueda: " << rueda.programados << " programados, " << rueda.ejecutados
+              << " ejecutados, " << rueda.segundos << " s\n"
+              << "  " << double (entrada.programados) / rueda.programados << " veces menos eventos, "
+              << entrada.segundos / rueda.segundos << " veces menos tiempo\n";
+    double retrasoMedio = rueda.vencidos.empty () ? 0 : rueda.retrasoTotal / rueda.vencidos.size ();
+    bool acotado = rueda.fuera == 0 && retrasoMedio <= 0.55 * resolucion;
+    return diferencias == 0 && mismos && acotado ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TESIS_UTILIDADES_H
+#define TESIS_UTILIDADES_H
+
+/*
+ * Listas de la linea de comandos y directorios de salida, comunes a los
+ * bancos que lanzan los scripts (barrido, escala).
+ */
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Partes no vacias de una lista separada por comas
+inline std::vector<std::string>
+Separar (const std::string &lista)
+{
+    std::vector<std::string> partes;
+    std::istringstream is (lista);
+    std::string parte;
+    while (std::getline (is, parte, ','))
+    {
+        if (!parte.empty ())
+        {
+            partes.push_back (parte);
+        }
+    }
+    return partes;
+}
+
+inline std::vector<uint32_t>
+SepararEnteros (const std::string &lista)
+{
+    std::vector<uint32_t> valores;
+    for (const std::string &parte : Separar (lista))
+    {
+        valores.push_back (std::strtoul (parte.c_str (), 0, 10));
+    }
+    return valores;
+}
+
+// Crea la ruta y los directorios intermedios que falten (como mkdir -p)
+inline bool
+CrearDirectorio (const std::string &ruta)
+{
+    std::string parcial;
+    std::istringstream is (ruta);
+    std::string parte;
+    if (!ruta.empty () && ruta[0] == '/')
+    {
+        parcial = "/";
+    }
+    while (std::getline (is, parte, '/'))
+    {
+        if (parte.empty ())
+        {
+            continue;
+        }
+        parcial += parte + "/";
+        if (mkdir (parcial.c_str (), 0755) != 0 && errno != EEXIST)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif /* TESIS_UTILIDADES_H */